@@ -0,0 +1,132 @@
+#include "outOfCore.h"
+
+#define OOC_N 4000        // matrix size (can exceed RAM; disk is the limit)
+#define OOC_TILE 512      // tile edge, multiple of 32
+#define OOC_MEMORY_MB 256 // tile memory the multiply may hold
+#define OOC_DIR "."       // where the tiled matrix files are written
+
+// Check one full row and one full column of C against the naive product,
+// reading A and B back from their files. Returns the number of mismatches.
+static long checkRowCol(const ooc_matrix_t* A, const ooc_matrix_t* B, const ooc_matrix_t* C,
+                        int row, int col)
+{
+    int n = A->n;
+    int* a = (int*)malloc(n * sizeof(int));
+    int* b = (int*)malloc(n * sizeof(int));
+    int* c = (int*)malloc(n * sizeof(int));
+    int* expect = (int*)calloc(n, sizeof(int));
+    long errors = 0;
+    if (a == NULL || b == NULL || c == NULL || expect == NULL) {
+        printf("Memory allocation failed!\n");
+        errors = -1;
+        goto done;
+    }
+
+    // Row: C[row][j] = sum_k A[row][k] * B[k][j], one row of B at a time
+    if (oocReadRow(A, row, a) != 0) { errors = -1; goto done; }
+    for (int k = 0; k < n; k++) {
+        if (oocReadRow(B, k, b) != 0) { errors = -1; goto done; }
+        for (int j = 0; j < n; j++)
+            expect[j] += a[k] * b[j];
+    }
+    if (oocReadRow(C, row, c) != 0) { errors = -1; goto done; }
+    for (int j = 0; j < n; j++)
+        if (c[j] != expect[j]) errors++;
+
+    // Column: C[i][col] = A[i][:] . B[:][col], one row of A at a time
+    if (oocReadCol(B, col, b) != 0 || oocReadCol(C, col, c) != 0) { errors = -1; goto done; }
+    for (int i = 0; i < n; i++) {
+        if (oocReadRow(A, i, a) != 0) { errors = -1; goto done; }
+        int sum = 0;
+        for (int k = 0; k < n; k++)
+            sum += a[k] * b[k];
+        if (c[i] != sum) errors++;
+    }
+
+done:
+    free(a);
+    free(b);
+    free(c);
+    free(expect);
+    return errors;
+}
+
+// Usage: ./mainOOC [N] [tile] [memory MB]
+int main(int argc, char* argv[])
+{
+    int n = (argc > 1) ? atoi(argv[1]) : OOC_N;
+    int tile = (argc > 2) ? atoi(argv[2]) : OOC_TILE;
+    long memoryMB = (argc > 3) ? atol(argv[3]) : OOC_MEMORY_MB;
+    if (n < 1 || tile < 32 || memoryMB < 1) {
+        fprintf(stderr, "Usage: %s [N >= 1] [tile >= 32] [memory MB >= 1]\n", argv[0]);
+        return -1;
+    }
+
+    ooc_matrix_t A, B, C;
+    char pathA[256], pathB[256], pathC[256];
+    snprintf(pathA, sizeof(pathA), "%s/oocA.bin", OOC_DIR);
+    snprintf(pathB, sizeof(pathB), "%s/oocB.bin", OOC_DIR);
+    snprintf(pathC, sizeof(pathC), "%s/oocC.bin", OOC_DIR);
+
+    if (oocCreate(&A, pathA, n, tile) || oocCreate(&B, pathB, n, tile) ||
+        oocCreate(&C, pathC, n, tile)) {
+        return -1;
+    }
+
+    int status = 0;
+
+    // Initialize matrices A and B
+    if (oocFill(&A, 1) != 0 || oocFill(&B, 2) != 0) {
+        status = -1;
+        goto cleanup;
+    }
+
+    printf("Tiled matrices created: %dx%d, %dx%d tiles of %d, %ld MB tile memory\n",
+           n, n, A.grid, A.grid, tile, memoryMB);
+
+    // What the device can deliver, for comparison; this also leaves A
+    // out of the page cache
+    double deviceRate = oocReadBandwidth(&A);
+    oocDropCache(&B);
+
+    ooc_stats_t stats;
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    if (oocMatrixMultiply(&A, &B, &C, (size_t)memoryMB << 20, &stats) != 0) {
+        printf("Out-of-core multiplication failed!\n");
+        status = -1;
+        goto cleanup;
+    }
+    fsync(C.fd);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    double elapsed = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+    double bytesMoved = (double)stats.bytesRead + stats.bytesWritten;
+    double ops = 2.0 * A.grid * A.grid * A.grid * (double)tile * tile * tile;
+    printf("Out-of-core multiplication complete!\n");
+    printf("Elapsed time: %f seconds (%.2f GFLOP/s on padded tiles)\n", elapsed, ops / 1e9 / elapsed);
+    printf("Block rows per pass: %d, B streamed %d time(s)\n", stats.rowsPerPass, stats.passes);
+    printf("Tile I/O: %.2f GB read, %.2f GB written, %.3f GB/s achieved\n",
+           stats.bytesRead / 1e9, stats.bytesWritten / 1e9, bytesMoved / 1e9 / elapsed);
+    if (deviceRate > 0)
+        printf("Device sequential read: %.3f GB/s, so the multiply used %.1f%% of it%s\n",
+               deviceRate / 1e9, 100.0 * bytesMoved / elapsed / deviceRate,
+               (bytesMoved / elapsed < 0.5 * deviceRate) ? " (compute bound)" : "");
+
+    // Full row and column against the naive product, both crossing the
+    // zero-padded edge tiles
+    long errors = checkRowCol(&A, &B, &C, n - 1, n - 1);
+    printf("Verification (row %d and column %d): %s\n", n - 1, n - 1,
+           errors == 0 ? "passed" : "FAILED");
+    if (errors != 0) status = -1;
+
+cleanup:
+    oocClose(&A);
+    oocClose(&B);
+    oocClose(&C);
+    unlink(pathA);
+    unlink(pathB);
+    unlink(pathC);
+
+    return status;
+}
@@ -0,0 +1,408 @@
+#ifndef OUT_OF_CORE_H
+#define OUT_OF_CORE_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+
+// On-disk tiled matrix: a one-page header followed by grid x grid tiles in
+// row-major tile order, each tile holding tile x tile ints row-major. Edge
+// tiles are zero padded, so every tile has the same size and offset rule.
+#define OOC_HEADER 4096
+#define OOC_MAGIC 0x4f4f434d   // "OOCM"
+#define OOC_PREFETCH_DEPTH 4   // tiles the prefetch thread runs ahead
+
+typedef struct {
+    int magic;
+    int n;      // logical matrix size
+    int tile;   // tile edge, multiple of 32 so tiles stay page aligned
+    int grid;   // tiles per row/column
+} ooc_header_t;
+
+typedef struct {
+    int fd;
+    int n, tile, grid;
+    size_t tileBytes;
+} ooc_matrix_t;
+
+static int oocGrid(int n, int tile) { return (n + tile - 1) / tile; }
+
+// Create (or truncate) a zero-filled tiled matrix file
+int oocCreate(ooc_matrix_t* M, const char* path, int n, int tile)
+{
+    if (tile % 32 != 0) {
+        fprintf(stderr, "Tile size %d must be a multiple of 32\n", tile);
+        return -1;
+    }
+
+    M->fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (M->fd < 0) {
+        perror("open");
+        return -1;
+    }
+    M->n = n;
+    M->tile = tile;
+    M->grid = oocGrid(n, tile);
+    M->tileBytes = (size_t)tile * tile * sizeof(int);
+
+    ooc_header_t h = {OOC_MAGIC, n, tile, M->grid};
+    if (ftruncate(M->fd, OOC_HEADER + (off_t)M->grid * M->grid * M->tileBytes) != 0 ||
+        pwrite(M->fd, &h, sizeof(h), 0) != sizeof(h)) {
+        perror("ftruncate/pwrite");
+        close(M->fd);
+        return -1;
+    }
+    return 0;
+}
+
+int oocOpen(ooc_matrix_t* M, const char* path)
+{
+    ooc_header_t h;
+    M->fd = open(path, O_RDWR);
+    if (M->fd < 0 || pread(M->fd, &h, sizeof(h), 0) != sizeof(h) || h.magic != OOC_MAGIC) {
+        fprintf(stderr, "%s is not a tiled matrix file\n", path);
+        if (M->fd >= 0) close(M->fd);
+        return -1;
+    }
+    M->n = h.n;
+    M->tile = h.tile;
+    M->grid = h.grid;
+    M->tileBytes = (size_t)h.tile * h.tile * sizeof(int);
+    return 0;
+}
+
+void oocClose(ooc_matrix_t* M)
+{
+    fsync(M->fd);
+    close(M->fd);
+}
+
+static off_t oocTileOffset(const ooc_matrix_t* M, int ti, int tj)
+{
+    return OOC_HEADER + ((off_t)ti * M->grid + tj) * M->tileBytes;
+}
+
+int* oocMapTile(const ooc_matrix_t* M, int ti, int tj, int writable)
+{
+    int prot = PROT_READ | (writable ? PROT_WRITE : 0);
+    void* p = mmap(NULL, M->tileBytes, prot, MAP_SHARED, M->fd, oocTileOffset(M, ti, tj));
+    if (p == MAP_FAILED) {
+        perror("mmap");
+        return NULL;
+    }
+    return (int*)p;
+}
+
+void oocUnmapTile(const ooc_matrix_t* M, int* tile)
+{
+    munmap(tile, M->tileBytes);
+}
+
+// Small deterministic values in [-3, 3], so products of any practical size
+// fit in an int and a wrong tile shows up in the check
+static int oocPattern(int i, int j, int seed)
+{
+    return (int)(((long)i * 31 + (long)j * 17 + seed) % 7) - 3;
+}
+
+// Set every logical element from the pattern (padding stays zero)
+int oocFill(ooc_matrix_t* M, int seed)
+{
+    for (int ti = 0; ti < M->grid; ti++) {
+        for (int tj = 0; tj < M->grid; tj++) {
+            int* t = oocMapTile(M, ti, tj, 1);
+            if (t == NULL) return -1;
+            int rows = (ti == M->grid - 1) ? M->n - ti * M->tile : M->tile;
+            int cols = (tj == M->grid - 1) ? M->n - tj * M->tile : M->tile;
+            for (int i = 0; i < rows; i++)
+                for (int j = 0; j < cols; j++)
+                    t[i * M->tile + j] = oocPattern(ti * M->tile + i, tj * M->tile + j, seed);
+            oocUnmapTile(M, t);
+        }
+    }
+    return 0;
+}
+
+// Copy logical row i into out[0..n)
+int oocReadRow(const ooc_matrix_t* M, int i, int* out)
+{
+    int ti = i / M->tile, r = i % M->tile;
+    for (int tj = 0; tj < M->grid; tj++) {
+        int* t = oocMapTile(M, ti, tj, 0);
+        if (t == NULL) return -1;
+        int cols = (tj == M->grid - 1) ? M->n - tj * M->tile : M->tile;
+        memcpy(out + tj * M->tile, t + r * M->tile, cols * sizeof(int));
+        oocUnmapTile(M, t);
+    }
+    return 0;
+}
+
+// Copy logical column j into out[0..n)
+int oocReadCol(const ooc_matrix_t* M, int j, int* out)
+{
+    int tj = j / M->tile, c = j % M->tile;
+    for (int ti = 0; ti < M->grid; ti++) {
+        int* t = oocMapTile(M, ti, tj, 0);
+        if (t == NULL) return -1;
+        int rows = (ti == M->grid - 1) ? M->n - ti * M->tile : M->tile;
+        for (int i = 0; i < rows; i++)
+            out[ti * M->tile + i] = t[i * M->tile + c];
+        oocUnmapTile(M, t);
+    }
+    return 0;
+}
+
+// Write the file back and drop its pages from the page cache, so the next
+// reads really come from the device
+void oocDropCache(const ooc_matrix_t* M)
+{
+    fsync(M->fd);
+    posix_fadvise(M->fd, 0, 0, POSIX_FADV_DONTNEED);
+}
+
+// Sequential read bandwidth of the device holding the file, in bytes per
+// second: drop the cache and read the tiles back in large chunks. This is
+// the ceiling the multiply's tile reads can be compared against.
+double oocReadBandwidth(const ooc_matrix_t* M)
+{
+    size_t chunk = 8 << 20;
+    char* buf = (char*)malloc(chunk);
+    if (buf == NULL) {
+        printf("Memory allocation failed!\n");
+        return -1;
+    }
+
+    oocDropCache(M);
+    off_t total = (off_t)M->grid * M->grid * M->tileBytes;
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    off_t done = 0;
+    while (done < total) {
+        ssize_t got = pread(M->fd, buf, chunk, OOC_HEADER + done);
+        if (got <= 0) break;
+        done += got;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    free(buf);
+
+    double elapsed = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+    return (done > 0 && elapsed > 0) ? done / elapsed : -1;
+}
+
+// ------------- Tile schedule and background prefetch ---------------
+
+typedef struct {
+    const ooc_matrix_t* M;
+    int ti, tj;
+} ooc_load_t;
+
+typedef struct {
+    ooc_load_t* loads;   // every tile read, in the order the multiply reads it
+    long count;
+    long consumed;       // loads the multiply has started
+    int done;
+    pthread_mutex_t lock;
+    pthread_cond_t advanced;
+} ooc_prefetch_t;
+
+// Touch the tile from the background thread so the page cache is warm by
+// the time the multiply maps it. Prefetch is only a hint: a tile that
+// can't be mapped here is skipped and the multiply reports the failure.
+static void* oocPrefetchWorker(void* arg)
+{
+    ooc_prefetch_t* pf = (ooc_prefetch_t*)arg;
+    long pageInts = sysconf(_SC_PAGESIZE) / sizeof(int);
+
+    for (long next = 0; next < pf->count; next++) {
+        pthread_mutex_lock(&pf->lock);
+        while (!pf->done && next >= pf->consumed + OOC_PREFETCH_DEPTH)
+            pthread_cond_wait(&pf->advanced, &pf->lock);
+        int done = pf->done;
+        pthread_mutex_unlock(&pf->lock);
+        if (done) break;
+
+        ooc_load_t* l = &pf->loads[next];
+        int* t = oocMapTile(l->M, l->ti, l->tj, 0);
+        if (t == NULL) continue;
+        madvise(t, l->M->tileBytes, MADV_WILLNEED);
+        volatile int sink = 0;
+        for (size_t x = 0; x < l->M->tileBytes / sizeof(int); x += pageInts)
+            sink += t[x];
+        (void)sink;
+        oocUnmapTile(l->M, t);
+    }
+    return NULL;
+}
+
+static void oocPrefetchAdvance(ooc_prefetch_t* pf)
+{
+    pthread_mutex_lock(&pf->lock);
+    pf->consumed++;
+    pthread_cond_signal(&pf->advanced);
+    pthread_mutex_unlock(&pf->lock);
+}
+
+// C_tile += A_tile * B_tile, all tile x tile
+static void oocTileMultiply(const int* A, const int* B, int* C, int tile)
+{
+    for (int i = 0; i < tile; i++) {
+        for (int k = 0; k < tile; k++) {
+            int a = A[i * tile + k];
+            if (a == 0) continue;
+            const int* b = B + k * tile;
+            int* c = C + i * tile;
+            for (int j = 0; j < tile; j++)
+                c[j] += a * b[j];
+        }
+    }
+}
+
+typedef struct {
+    size_t bytesRead;      // tile bytes mapped from A and B
+    size_t bytesWritten;   // tile bytes written to C
+    int rowsPerPass;       // block rows of A (and their C tiles) held at once
+    int passes;            // times B was streamed from end to end
+} ooc_stats_t;
+
+// Block rows of A that fit in memBytes along with one B tile; each needs
+// grid A tiles plus one C accumulator
+static int oocRowsPerPass(const ooc_matrix_t* A, size_t memBytes)
+{
+    size_t perRow = (size_t)(A->grid + 1) * A->tileBytes;
+    long rows = (memBytes > A->tileBytes) ? (long)((memBytes - A->tileBytes) / perRow) : 0;
+    if (rows < 1) rows = 1;
+    if (rows > A->grid) rows = A->grid;
+    return (int)rows;
+}
+
+// C = A * B over tiled files, holding about memBytes of tiles in memory.
+// Block rows of A are taken rowsPerPass at a time and stay mapped; every B
+// tile is then mapped once per pass and multiplied into the C accumulators
+// of all rows of the pass before it is dropped. A is read once, B
+// grid / rowsPerPass times (once when A fits), and each C tile is written
+// exactly once. The column sweep snakes back and forth between passes, so
+// the B panel that ends one pass, still in the page cache, starts the next.
+// Returns 0, or -1 if a tile can't be mapped or memory runs out.
+int oocMatrixMultiply(const ooc_matrix_t* A, const ooc_matrix_t* B, ooc_matrix_t* C,
+                      size_t memBytes, ooc_stats_t* stats)
+{
+    int g = A->grid, tile = A->tile;
+    int rows = oocRowsPerPass(A, memBytes);
+    int passes = (g + rows - 1) / rows;
+    size_t tileInts = (size_t)tile * tile;
+    int status = 0;
+
+    memset(stats, 0, sizeof(*stats));
+    stats->rowsPerPass = rows;
+    stats->passes = passes;
+
+    ooc_prefetch_t pf;
+    pf.count = (long)g * g + (long)passes * g * g;
+    pf.loads = (ooc_load_t*)malloc(pf.count * sizeof(ooc_load_t));
+    int** panelA = (int**)calloc((size_t)rows * g, sizeof(int*));
+    int* acc = (int*)malloc(rows * A->tileBytes);
+    if (pf.loads == NULL || panelA == NULL || acc == NULL) {
+        printf("Memory allocation failed!\n");
+        free(pf.loads);
+        free(panelA);
+        free(acc);
+        return -1;
+    }
+    pf.consumed = 0;
+    pf.done = 0;
+    pthread_mutex_init(&pf.lock, NULL);
+    pthread_cond_init(&pf.advanced, NULL);
+
+    long s = 0;
+    for (int p = 0; p < passes; p++) {
+        int i0 = p * rows, i1 = (i0 + rows < g) ? i0 + rows : g;
+        for (int i = i0; i < i1; i++)
+            for (int k = 0; k < g; k++)
+                pf.loads[s++] = (ooc_load_t){A, i, k};
+        for (int jj = 0; jj < g; jj++) {
+            int j = (p % 2 == 0) ? jj : g - 1 - jj;
+            for (int k = 0; k < g; k++)
+                pf.loads[s++] = (ooc_load_t){B, k, j};
+        }
+    }
+
+    pthread_t prefetcher;
+    pthread_create(&prefetcher, NULL, oocPrefetchWorker, &pf);
+
+    for (int p = 0; p < passes && status == 0; p++) {
+        int i0 = p * rows;
+        int held = (i0 + rows < g) ? rows : g - i0;
+
+        for (int r = 0; r < held && status == 0; r++) {
+            for (int k = 0; k < g; k++) {
+                int* t = oocMapTile(A, i0 + r, k, 0);
+                oocPrefetchAdvance(&pf);
+                if (t == NULL) {
+                    status = -1;
+                    break;
+                }
+                madvise(t, A->tileBytes, MADV_SEQUENTIAL);
+                panelA[r * g + k] = t;
+                stats->bytesRead += A->tileBytes;
+            }
+        }
+
+        for (int jj = 0; jj < g && status == 0; jj++) {
+            int j = (p % 2 == 0) ? jj : g - 1 - jj;
+            memset(acc, 0, held * A->tileBytes);
+
+            for (int k = 0; k < g; k++) {
+                int* tB = oocMapTile(B, k, j, 0);
+                oocPrefetchAdvance(&pf);
+                if (tB == NULL) {
+                    status = -1;
+                    break;
+                }
+                for (int r = 0; r < held; r++)
+                    oocTileMultiply(panelA[r * g + k], tB, acc + r * tileInts, tile);
+                oocUnmapTile(B, tB);
+                stats->bytesRead += B->tileBytes;
+            }
+
+            for (int r = 0; r < held && status == 0; r++) {
+                int* tC = oocMapTile(C, i0 + r, j, 1);
+                if (tC == NULL) {
+                    status = -1;
+                    break;
+                }
+                memcpy(tC, acc + r * tileInts, C->tileBytes);
+                oocUnmapTile(C, tC);
+                stats->bytesWritten += C->tileBytes;
+            }
+        }
+
+        for (int x = 0; x < held * g; x++) {
+            if (panelA[x] != NULL) {
+                oocUnmapTile(A, panelA[x]);
+                panelA[x] = NULL;
+            }
+        }
+    }
+
+    pthread_mutex_lock(&pf.lock);
+    pf.done = 1;
+    pthread_cond_signal(&pf.advanced);
+    pthread_mutex_unlock(&pf.lock);
+    pthread_join(prefetcher, NULL);
+
+    pthread_mutex_destroy(&pf.lock);
+    pthread_cond_destroy(&pf.advanced);
+    free(pf.loads);
+    free(panelA);
+    free(acc);
+
+    return status;
+}
+
+#endif
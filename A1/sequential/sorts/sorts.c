@@ -1,57 +1,118 @@
 #include "sorts.h"
 
 // Merge Sort 
-static void merge(int arr[], int left, int mid, int right) 
+#define INSERTION_CUTOFF 32 // runs this short are insertion sorted
+
+static void insertionSort(int arr[], int left, int right)
+{
+	for (int i = left + 1; i <= right; i++) {
+		int key = arr[i];
+		int j = i - 1;
+		while (j >= left && arr[j] > key) {
+			arr[j + 1] = arr[j];
+			j--;
+		}
+		arr[j + 1] = key;
+	}
+}
+
+// Merge src[left..mid] and src[mid+1..right] into dst[left..right]
+static void merge(const int src[], int dst[], int left, int mid, int right) 
 {
-	int n1 = mid - left + 1; // length of left subarray
-	int n2 = right - mid; // length of right subarray
+	int i = left, j = mid + 1, k = left;
+	while (i <= mid && j <= right) {
+		if (src[i] <= src[j])
+			dst[k++] = src[i++];
+		else
+			dst[k++] = src[j++];
+	}
 
-	// Temp arrays
-	int L[n1], R[n2];
+	// Copy whichever run has elements left
+	while (i <= mid)
+		dst[k++] = src[i++];
+	while (j <= right)
+		dst[k++] = src[j++];
+}
 
-	// Copying data to temp arrays
-	for (int i = 0; i < n1; i++)
-		L[i] = arr[left + i];
-	for (int j = 0; j < n2; j++)
-		R[j] = arr[mid + 1 + j];
+// End (exclusive) of the run starting at lo. A strictly descending run is
+// reversed so that every run comes back ascending; equal elements never
+// start a descending run, which keeps the sort stable.
+static int findRun(int arr[], int lo, int n)
+{
+	int hi = lo + 1;
+	if (hi == n)
+		return hi;
 
-	// Merge temp arrays back into arr[left..right]
-	int i = 0, j = 0, k = left;
-	while (i < n1 && j < n2) {
-		if (L[i] <= R[j]) {
-			arr[k] = L[i];
-			i++;
-		} else {
-			arr[k] = R[j];
-			j++;
+	if (arr[hi++] < arr[lo]) {
+		while (hi < n && arr[hi] < arr[hi - 1])
+			hi++;
+		for (int i = lo, j = hi - 1; i < j; i++, j--) {
+			int temp = arr[i];
+			arr[i] = arr[j];
+			arr[j] = temp;
 		}
-		k++;
+	} else {
+		while (hi < n && arr[hi] >= arr[hi - 1])
+			hi++;
 	}
+	return hi;
+}
 
-	// Copy any remaining elements of L[]
-	while (i < n1) {
-		arr[k] = L[i];
-		i++;
-		k++;
+// Natural merge sort: cut the input into the runs it already has (runs
+// shorter than INSERTION_CUTOFF are extended by insertion sort), then merge
+// neighbouring runs pairwise, back and forth between arr and one scratch
+// buffer, until a single run is left. Sorted or reversed input is one run
+// and costs one O(n) scan; random input does the usual log n passes.
+void mergeSort(int arr[], int left, int right) 
+{
+	int n = right - left + 1;
+	if (n < 2)
+		return;
+
+	// Start of every run, plus n at the end. Every run but the last is at
+	// least INSERTION_CUTOFF long, which bounds how many there can be.
+	int* a = arr + left;
+	int* runs = malloc((n / INSERTION_CUTOFF + 2) * sizeof(int));
+	int count = 0;
+	for (int lo = 0; lo < n; ) {
+		int hi = findRun(a, lo, n);
+		if (hi - lo < INSERTION_CUTOFF) {
+			hi = (lo + INSERTION_CUTOFF < n) ? lo + INSERTION_CUTOFF : n;
+			insertionSort(a, lo, hi - 1);
+		}
+		runs[count++] = lo;
+		lo = hi;
 	}
+	runs[count] = n;
 
-	// Copy any remaining elements of R[]
-	while (j < n2) {
-		arr[k] = R[j];
-		j++;
-		k++;
+	int* buf = (count > 1) ? malloc(n * sizeof(int)) : NULL;
+	int* src = a;
+	int* dst = buf;
+	while (count > 1) {
+		int merged = 0;
+		for (int r = 0; r < count; r += 2) {
+			if (r + 1 < count)
+				merge(src, dst, runs[r], runs[r + 1] - 1, runs[r + 2] - 1);
+			else
+				for (int i = runs[r]; i < n; i++)
+					dst[i] = src[i];
+			runs[merged++] = runs[r];
+		}
+		runs[merged] = n;
+		count = merged;
+
+		int* temp = src;
+		src = dst;
+		dst = temp;
 	}
 
-}
+	// An odd number of passes leaves the result in the buffer
+	if (src != a)
+		for (int i = 0; i < n; i++)
+			a[i] = src[i];
 
-void mergeSort(int arr[], int left, int right) 
-{
-    if (left < right) {
-        int mid = left + (right - left) / 2;
-        mergeSort(arr, left, mid);
-        mergeSort(arr, mid + 1, right);
-        merge(arr, left, mid, right);
-    }
+	free(runs);
+	free(buf);
 }
 
 // Bubble Sort
@@ -1,10 +1,17 @@
 #include "matrixT.h"
+#include "../common/freivalds.h"
 
-int main() 
+#define SEQ_BASELINE 1  // 0 skips the O(N^3) sequential timing run
+
+int main(int argc, char* argv[]) 
 {
+    // Thread count from the command line, defaulting to one per CPU
+    num_threads = (argc > 1) ? atoi(argv[1]) : (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if (num_threads < 1) num_threads = 1;
+
     // declare thread id and thread data
-    pthread_t threads[NUM_THREADS];
-    thread_data_t thread_data[NUM_THREADS];
+    pthread_t* threads = (pthread_t*)malloc(num_threads * sizeof(pthread_t));
+    thread_data_t* thread_data = (thread_data_t*)malloc(num_threads * sizeof(thread_data_t));
 
     // Dynamically allocate memory for the matrices
     A = (int**)malloc(N * sizeof(int*));
@@ -33,27 +40,48 @@ int main()
 
     printf("Matrices initialized successfully.\n");
 
-	int rows_per_thread = N / NUM_THREADS;
+	int rows_per_thread = N / num_threads;
 
-    // Create threads to perform matrix multiplication
-	for (int i = 0; i < NUM_THREADS; i++) {
+    // Approach 1: fixed block of rows per thread
+	double start = wall_time();
+	for (int i = 0; i < num_threads; i++) {
 		thread_data[i].thread_id = i;
 		thread_data[i].num_rows = rows_per_thread;
 		pthread_create(&threads[i], NULL, matrixMultiplyThread, (void *)&thread_data[i]);
 	}
 
     // Wait for all threads to complete
-	for (int i = 0; i < NUM_THREADS; i++) {
+	for (int i = 0; i < num_threads; i++) {
 		pthread_join(threads[i], NULL);
 	}
+	printf("Row-block matrix multiplication time (%d threads): %f seconds \n", num_threads, wall_time() - start);
+
+    // Approach 2: threads pull output tiles from a shared counter
+	start = wall_time();
+	atomic_store(&next_tile, 0);
+	for (int i = 0; i < num_threads; i++) {
+		pthread_create(&threads[i], NULL, matrixMultiplyTiles, NULL);
+	}
+	for (int i = 0; i < num_threads; i++) {
+		pthread_join(threads[i], NULL);
+	}
+	double parallel_time = wall_time() - start;
+	printf("Tiled matrix multiplication time (%d threads): %f seconds \n", num_threads, parallel_time);
 
     printf("Matrix multiplication complete!\n");
 
     // Optionally, display the resulting matrix C (Not when you are timing :) )
 //    displayMatrix(C, N);
 
-	// Sequential part for timing purpose
-	clock_t start = clock();
+	// Probabilistic check of the tiled result, O(N^2) per round
+	start = wall_time();
+	int ok = freivaldsVerify(A, B, C, N, FREIVALDS_ROUNDS);
+	printf("Verification (%d Freivalds rounds): %s, %f seconds \n", FREIVALDS_ROUNDS, ok == FREIVALDS_NOMEM ? "not run (out of memory)" : ok ? "passed" : "FAILED", wall_time() - start);
+
+#if SEQ_BASELINE
+	// Sequential part for timing purpose (wall clock: clock() adds up the
+	// CPU time of every thread, which hides any parallel speedup)
+	start = wall_time();
 	for (int i = 0; i < N; i++) {
 		for (int j = 0; j < N; j++) {
 			C[i][j] = 0;
@@ -63,9 +91,10 @@ int main()
 		}
 	}
 
-	clock_t end = clock();
-	double time_spent = (double)(end - start) / CLOCKS_PER_SEC;
+	double time_spent = wall_time() - start;
 	printf("Sequential matrix multiplication time: %f seconds \n", time_spent);
+	printf("Speedup (tiled): %.2fx\n", time_spent / parallel_time);
+#endif
 
 
     // Free dynamically allocated memory
@@ -77,6 +106,8 @@ int main()
     free(A);
     free(B);
     free(C);
+    free(threads);
+    free(thread_data);
 
     return 0;
 }
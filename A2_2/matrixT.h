@@ -1,11 +1,15 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <pthread.h>
+#include <stdatomic.h>
+#include <time.h>
+#include <unistd.h>
 
 #define N 1000  // Size of the matrix
-#define NUM_THREADS 1  // Number of threads
+#define TILE 64 // Edge of the square output tiles handed out by the scheduler
 
 int **A, **B, **C;  // Global matrices
+int num_threads = 1;  // Set at runtime (argv[1] or number of online CPUs)
 
 // Structure to hold information for each thread
 typedef struct 
@@ -23,9 +27,7 @@ void* matrixMultiplyThread(void* arg)
 	int thread_id = data->thread_id;
 	int rows_per_thread = data->num_rows;
 	int start_row = thread_id * rows_per_thread;
-	int end_row = (thread_id == NUM_THREADS - 1) ? N : start_row + rows_per_thread;
-
-	printf("Thread %d processing rows %d to %d\n", thread_id, start_row, end_row - 1);
+	int end_row = (thread_id == num_threads - 1) ? N : start_row + rows_per_thread;
 
 	for (int i = start_row; i < end_row; i++) {
 		for (int j = 0; j < N; j++) {
@@ -36,10 +38,60 @@ void* matrixMultiplyThread(void* arg)
 		}
 	}
 
-	printf("Thread %d finished\n", thread_id);
 	pthread_exit(NULL);
 }
 
+// ------------- Dynamic 2D tile scheduling ---------------------
+
+#define TILES_PER_SIDE ((N + TILE - 1) / TILE)
+
+atomic_int next_tile = 0;  // Next unclaimed output tile
+
+// Compute one TILE x TILE block of C into a private accumulator (i-k-j
+// order, so B and the accumulator are read along rows) and store it once
+static void computeTile(int tile)
+{
+	int row0 = (tile / TILES_PER_SIDE) * TILE;
+	int col0 = (tile % TILES_PER_SIDE) * TILE;
+	int rows = (row0 + TILE > N) ? N - row0 : TILE;
+	int cols = (col0 + TILE > N) ? N - col0 : TILE;
+	int acc[TILE];
+
+	for (int i = 0; i < rows; i++) {
+		for (int j = 0; j < cols; j++)
+			acc[j] = 0;
+
+		int* a = A[row0 + i];
+		for (int k = 0; k < N; k++) {
+			int aik = a[k];
+			int* b = B[k] + col0;
+			for (int j = 0; j < cols; j++)
+				acc[j] += aik * b[j];
+		}
+
+		int* c = C[row0 + i] + col0;
+		for (int j = 0; j < cols; j++)
+			c[j] = acc[j];
+	}
+}
+
+// Threads keep claiming tiles until none are left, so a slow thread
+// simply ends up with fewer tiles instead of holding everyone up
+void* matrixMultiplyTiles(void* arg)
+{
+	(void)arg;
+	int total = TILES_PER_SIDE * TILES_PER_SIDE;
+
+	for (;;) {
+		int tile = atomic_fetch_add_explicit(&next_tile, 1, memory_order_relaxed);
+		if (tile >= total)
+			break;
+		computeTile(tile);
+	}
+
+	return NULL;
+}
+
 void displayMatrix(int** matrix, int n) 
 {
     for (int i = 0; i < n; ++i) {
@@ -49,3 +101,10 @@ void displayMatrix(int** matrix, int n)
         printf("\n");
     }
 }
+
+double wall_time(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
@@ -0,0 +1,509 @@
+// EXTERNAL MERGE SORT FOR BINARY INT FILES LARGER THAN MEMORY
+//
+// Build: gcc -O3 -march=native ext_sort.c p_radix.c -lpthread -o ext_sort
+//   ./ext_sort gen FILE COUNT        write COUNT random ints
+//   ./ext_sort IN OUT [MEMORY_MB]    sort IN into OUT
+//   ./ext_sort check FILE            verify FILE is sorted
+//
+// Pass 1 reads memory-sized runs, sorts each with the parallel radix sort
+// and writes it out, with the next read and the previous write in flight
+// while the current run is sorted. Pass 2 merges the runs through a loser
+// tree; every run and the output have two blocks so the disk is kept busy
+// on one while the merge works on the other. When there are too many runs
+// for blocks of MIN_BLOCK ints to fit the budget, they are first merged in
+// groups over extra passes. All reads and writes go through one long-lived
+// I/O thread; on an I/O error the temporary run files and the partial
+// output are removed.
+
+#define _FILE_OFFSET_BITS 64
+#include "p_merge.h"
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <limits.h>
+#include <errno.h>
+
+#define MEMORY_MB 1024      // default memory budget
+#define MIN_BLOCK 16384     // ints per merge block, even if over budget
+
+// ------------- Asynchronous I/O -------------------------------------
+
+// One pread/pwrite request. io_start() hands it to the I/O thread, which
+// works through requests in the order they were started; io_wait() blocks
+// until it is done. A failed transfer is reported back through error
+// instead of ending the process, so the caller can clean up.
+typedef struct io_req {
+    int fd;
+    int* buf;
+    long count;       // ints
+    off_t offset;     // bytes
+    int is_write;
+    int pending;      // started and not yet waited for
+    int busy;         // queued or in progress on the I/O thread
+    long done;        // ints transferred
+    int error;        // errno of a failed transfer, else 0
+    struct io_req* next;
+} io_t;
+
+// The single long-lived I/O thread and its request queue
+static struct {
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t queued;     // a request was started, or shutdown
+    pthread_cond_t finished;   // a request completed
+    io_t* head;
+    io_t* tail;
+    int shutdown;
+} io_engine = {.lock = PTHREAD_MUTEX_INITIALIZER,
+               .queued = PTHREAD_COND_INITIALIZER,
+               .finished = PTHREAD_COND_INITIALIZER};
+
+static void io_perform(io_t* io) {
+    char* p = (char*)io->buf;
+    size_t left = io->count * sizeof(int);
+    off_t off = io->offset;
+
+    io->error = 0;
+    while (left > 0) {
+        ssize_t n = io->is_write ? pwrite(io->fd, p, left, off) : pread(io->fd, p, left, off);
+        if (n < 0) {
+            io->error = errno;
+            perror(io->is_write ? "pwrite" : "pread");
+            break;
+        }
+        if (n == 0) break;  // end of file
+        p += n;
+        off += n;
+        left -= n;
+    }
+    if (io->is_write && left > 0 && !io->error)
+        io->error = EIO;   // a write must not come up short
+    io->done = (long)((p - (char*)io->buf) / sizeof(int));
+}
+
+void* io_worker(void* arg) {
+    (void)arg;
+    pthread_mutex_lock(&io_engine.lock);
+    while (1) {
+        while (!io_engine.head && !io_engine.shutdown)
+            pthread_cond_wait(&io_engine.queued, &io_engine.lock);
+        if (!io_engine.head) break;   // shutdown with nothing left to do
+
+        io_t* io = io_engine.head;
+        io_engine.head = io->next;
+        if (!io_engine.head) io_engine.tail = NULL;
+        pthread_mutex_unlock(&io_engine.lock);
+
+        io_perform(io);
+
+        pthread_mutex_lock(&io_engine.lock);
+        io->busy = 0;
+        pthread_cond_broadcast(&io_engine.finished);
+    }
+    pthread_mutex_unlock(&io_engine.lock);
+    return NULL;
+}
+
+int io_init(void) {
+    io_engine.head = io_engine.tail = NULL;
+    io_engine.shutdown = 0;
+    if (pthread_create(&io_engine.thread, NULL, io_worker, NULL)) {
+        fprintf(stderr, "Error creating I/O thread\n");
+        return -1;
+    }
+    return 0;
+}
+
+// Finishes every queued request, then stops the I/O thread
+void io_shutdown(void) {
+    pthread_mutex_lock(&io_engine.lock);
+    io_engine.shutdown = 1;
+    pthread_cond_signal(&io_engine.queued);
+    pthread_mutex_unlock(&io_engine.lock);
+    pthread_join(io_engine.thread, NULL);
+}
+
+void io_start(io_t* io, int fd, int* buf, long count, off_t offset, int is_write) {
+    io->fd = fd;
+    io->buf = buf;
+    io->count = count;
+    io->offset = offset;
+    io->is_write = is_write;
+    io->next = NULL;
+
+    io->pending = 1;
+    pthread_mutex_lock(&io_engine.lock);
+    io->busy = 1;
+    if (io_engine.tail) io_engine.tail->next = io;
+    else io_engine.head = io;
+    io_engine.tail = io;
+    pthread_cond_signal(&io_engine.queued);
+    pthread_mutex_unlock(&io_engine.lock);
+}
+
+// Ints transferred (0 at end of file or if nothing was started), or -1 if
+// the transfer failed
+long io_wait(io_t* io) {
+    if (!io->pending) return 0;
+    pthread_mutex_lock(&io_engine.lock);
+    while (io->busy)
+        pthread_cond_wait(&io_engine.finished, &io_engine.lock);
+    pthread_mutex_unlock(&io_engine.lock);
+    io->pending = 0;
+    return io->error ? -1 : io->done;
+}
+
+// ------------- Pass 1: sorted runs ----------------------------------
+
+// Returns the number of runs, or -1 on an I/O or allocation failure; run
+// r is ints run_start[r] .. run_start[r+1]-1 of the runs file
+int make_runs(int in_fd, int runs_fd, long run_len, int num_threads, long** run_start_out) {
+    int* buf[3];
+    int cap = 64, num_runs = 0, status = 0;
+    long* run_start = (long*)malloc((cap + 1) * sizeof(long));
+    for (int i = 0; i < 3; i++)
+        buf[i] = (int*)malloc(run_len * sizeof(int));
+    if (!run_start || !buf[0] || !buf[1] || !buf[2]) {
+        fprintf(stderr, "Memory allocation failed!\n");
+        for (int i = 0; i < 3; i++) free(buf[i]);
+        free(run_start);
+        return -1;
+    }
+    run_start[0] = 0;
+
+    io_t reader = {0}, writer = {0};
+    off_t in_off = 0;
+    io_start(&reader, in_fd, buf[0], run_len, in_off, 0);
+
+    // buf[cur] is being sorted, buf[(cur+1)%3] read, buf[(cur+2)%3] written
+    for (int cur = 0;; cur = (cur + 1) % 3) {
+        long n = io_wait(&reader);
+        if (n < 0) status = -1;
+        if (n <= 0) break;
+        in_off += (off_t)n * sizeof(int);
+        io_start(&reader, in_fd, buf[(cur + 1) % 3], run_len, in_off, 0);
+
+        radix_sort_p(buf[cur], 0, (int)n - 1, num_threads);
+
+        if (io_wait(&writer) < 0) {
+            status = -1;
+            break;
+        }
+        io_start(&writer, runs_fd, buf[cur], n, (off_t)run_start[num_runs] * sizeof(int), 1);
+
+        if (num_runs == cap) {
+            cap *= 2;
+            run_start = (long*)realloc(run_start, (cap + 1) * sizeof(long));
+        }
+        run_start[num_runs + 1] = run_start[num_runs] + n;
+        num_runs++;
+    }
+    // nothing may still be using the buffers when they are freed
+    io_wait(&reader);
+    if (io_wait(&writer) < 0) status = -1;
+
+    for (int i = 0; i < 3; i++) free(buf[i]);
+    if (status != 0) {
+        free(run_start);
+        return -1;
+    }
+    *run_start_out = run_start;
+    return num_runs;
+}
+
+// ------------- Pass 2: loser-tree merge ------------------------------
+
+typedef struct {
+    int fd;
+    long next;        // next int of the run to read
+    long end;
+    int* blk[2];
+    long len[2];
+    int cur;          // block being consumed
+    long pos;
+    io_t io;          // read into blk[1 - cur]
+    int exhausted;
+} run_t;
+
+static void run_prefetch(run_t* run, long block) {
+    long n = run->end - run->next;
+    if (n > block) n = block;
+    if (n == 0) {
+        run->len[1 - run->cur] = 0;
+        return;
+    }
+    io_start(&run->io, run->fd, run->blk[1 - run->cur], n, (off_t)run->next * sizeof(int), 0);
+    run->len[1 - run->cur] = n;
+    run->next += n;
+}
+
+// Move to the next key, switching blocks (and starting the next read)
+// when the current one is used up. Returns -1 if that read failed.
+static int run_advance(run_t* run, long block) {
+    if (++run->pos < run->len[run->cur]) return 0;
+    if (io_wait(&run->io) < 0) return -1;
+    run->cur = 1 - run->cur;
+    run->pos = 0;
+    if (run->len[run->cur] == 0) {
+        run->exhausted = 1;
+        return 0;
+    }
+    run_prefetch(run, block);
+    return 0;
+}
+
+static inline int run_key(const run_t* run) {
+    return run->blk[run->cur][run->pos];
+}
+
+// Loser tree over k runs: tree[1..k-1] hold the loser of each match,
+// tree[0] the overall winner. Each run's head is cached in keys[] as
+// value * 2^32 + run, so ties break by run and a match is one compare;
+// an exhausted run is LLONG_MAX, and the virtual leaf k (LLONG_MIN) only
+// exists while the tree is built.
+static void lt_adjust(int* tree, const long long* keys, int k, int s) {
+    int winner = s;
+    for (int t = (s + k) / 2; t > 0; t /= 2) {
+        if (keys[tree[t]] < keys[winner]) {
+            int tmp = tree[t];
+            tree[t] = winner;
+            winner = tmp;
+        }
+    }
+    tree[0] = winner;
+}
+
+static inline long long lt_key(const run_t* run, int r) {
+    return run->exhausted ? LLONG_MAX : (long long)run_key(run) * 4294967296LL + r;
+}
+
+// Merge runs run_start[0..k) of runs_fd into out_fd. The output covers
+// the same ints the runs did, so one group of runs can be merged into a
+// longer run of the next pass's file. Returns 0, or -1 on an I/O failure.
+int merge_runs(int runs_fd, const long* run_start, int k, int out_fd, long block) {
+    if (k < 1) return 0;
+    int status = 0;
+    run_t* runs = (run_t*)calloc(k, sizeof(run_t));
+    long long* keys = (long long*)malloc((k + 1) * sizeof(long long));
+    int* tree = (int*)malloc(k * sizeof(int));
+    int* out[2] = {(int*)malloc(block * sizeof(int)), (int*)malloc(block * sizeof(int))};
+    int ok = runs && keys && tree && out[0] && out[1];
+    for (int r = 0; ok && r < k; r++) {
+        runs[r].blk[0] = (int*)malloc(block * sizeof(int));
+        runs[r].blk[1] = (int*)malloc(block * sizeof(int));
+        ok = runs[r].blk[0] && runs[r].blk[1];
+    }
+    if (!ok) {
+        fprintf(stderr, "Memory allocation failed!\n");
+        status = -1;
+    }
+
+    for (int r = 0; r < k && status == 0; r++) {
+        runs[r].fd = runs_fd;
+        runs[r].next = run_start[r];
+        runs[r].end = run_start[r + 1];
+        runs[r].cur = 1;  // so the first prefetch fills blk[0]
+        run_prefetch(&runs[r], block);
+        if (io_wait(&runs[r].io) < 0) status = -1;
+        runs[r].cur = 0;
+        runs[r].pos = 0;
+        runs[r].exhausted = runs[r].len[0] == 0;
+        if (!runs[r].exhausted) run_prefetch(&runs[r], block);
+    }
+
+    if (status == 0) {
+        for (int r = 0; r < k; r++) keys[r] = lt_key(&runs[r], r);
+        keys[k] = LLONG_MIN;
+
+        for (int t = 0; t < k; t++) tree[t] = k;
+        for (int s = k - 1; s >= 0; s--) lt_adjust(tree, keys, k, s);
+
+        int cur = 0;
+        long fill = 0;
+        off_t out_off = (off_t)run_start[0] * sizeof(int);
+        io_t writer = {0};
+
+        while (status == 0 && keys[tree[0]] != LLONG_MAX) {
+            int w = tree[0];
+            out[cur][fill++] = (int)(keys[w] >> 32);
+            if (fill == block) {
+                if (io_wait(&writer) < 0) {
+                    status = -1;
+                    break;
+                }
+                io_start(&writer, out_fd, out[cur], fill, out_off, 1);
+                out_off += (off_t)fill * sizeof(int);
+                cur = 1 - cur;
+                fill = 0;
+            }
+            if (run_advance(&runs[w], block) < 0) status = -1;
+            keys[w] = lt_key(&runs[w], w);
+            lt_adjust(tree, keys, k, w);
+        }
+        if (io_wait(&writer) < 0) status = -1;
+        if (status == 0 && fill > 0) {
+            io_start(&writer, out_fd, out[cur], fill, out_off, 1);
+            if (io_wait(&writer) < 0) status = -1;
+        }
+    }
+
+    // every read must be finished before its block is freed
+    for (int r = 0; runs && r < k; r++) {
+        io_wait(&runs[r].io);
+        free(runs[r].blk[0]);
+        free(runs[r].blk[1]);
+    }
+    free(runs);
+    free(keys);
+    free(tree);
+    free(out[0]);
+    free(out[1]);
+    return status;
+}
+
+// Ints per block when k runs are merged in memory bytes: two blocks per
+// run and two for the output
+static long merge_block(long memory, int k) {
+    long block = memory / (2 * (k + 1) * (long)sizeof(int));
+    return block < MIN_BLOCK ? MIN_BLOCK : block;
+}
+
+// ------------- Driver -----------------------------------------------
+
+static double elapsed_ms(struct timespec start, struct timespec end) {
+    return (end.tv_sec - start.tv_sec) * 1000.0 + (end.tv_nsec - start.tv_nsec) / 1000000.0;
+}
+
+int generate(const char* path, long count) {
+    FILE* f = fopen(path, "wb");
+    if (!f) { perror(path); return 1; }
+    int* buf = (int*)malloc(MIN_BLOCK * sizeof(int));
+    srand(time(NULL));
+    for (long done = 0; done < count; ) {
+        long n = count - done < MIN_BLOCK ? count - done : MIN_BLOCK;
+        for (long i = 0; i < n; i++) buf[i] = rand();
+        fwrite(buf, sizeof(int), n, f);
+        done += n;
+    }
+    free(buf);
+    fclose(f);
+    return 0;
+}
+
+int check(const char* path) {
+    FILE* f = fopen(path, "rb");
+    if (!f) { perror(path); return 1; }
+    int* buf = (int*)malloc(MIN_BLOCK * sizeof(int));
+    long total = 0, errors = 0;
+    int prev = 0;
+    size_t n;
+    while ((n = fread(buf, sizeof(int), MIN_BLOCK, f)) > 0) {
+        for (size_t i = 0; i < n; i++) {
+            if (total + (long)i > 0 && buf[i] < prev) errors++;
+            prev = buf[i];
+        }
+        total += n;
+    }
+    printf("%ld ints, %s\n", total, errors ? "NOT sorted" : "sorted");
+    free(buf);
+    fclose(f);
+    return errors != 0;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc >= 4 && strcmp(argv[1], "gen") == 0)
+        return generate(argv[2], atol(argv[3]));
+    if (argc >= 3 && strcmp(argv[1], "check") == 0)
+        return check(argv[2]);
+    if (argc < 3) {
+        fprintf(stderr, "usage: %s IN OUT [MEMORY_MB] | gen FILE COUNT | check FILE\n", argv[0]);
+        return 1;
+    }
+
+    long memory = (argc > 3 ? atol(argv[3]) : MEMORY_MB) * 1024L * 1024L;
+    int num_threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    struct timespec start, mid, end;
+
+    int in_fd = open(argv[1], O_RDONLY);
+    if (in_fd < 0) { perror(argv[1]); return 1; }
+    char runs_path[2][4096];
+    snprintf(runs_path[0], sizeof(runs_path[0]), "%s.runs", argv[2]);
+    snprintf(runs_path[1], sizeof(runs_path[1]), "%s.runs2", argv[2]);
+    int which = 0;   // runs_path[which] holds the current runs
+    int runs_fd = open(runs_path[0], O_RDWR | O_CREAT | O_TRUNC, 0644);
+    int out_fd = open(argv[2], O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (runs_fd < 0 || out_fd < 0) { perror(argv[2]); return 1; }
+    if (io_init() != 0) return 1;
+
+    // Pass 1 holds three run buffers plus the radix sort's scratch copy
+    long run_len = memory / (4 * sizeof(int));
+    if (run_len > 0x7fffffffL) run_len = 0x7fffffffL;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    long* run_start = NULL;
+    int k = make_runs(in_fd, runs_fd, run_len, num_threads, &run_start);
+    int status = (k < 0) ? -1 : 0;
+    clock_gettime(CLOCK_MONOTONIC, &mid);
+
+    // Merge at most fan_in runs at a time so every block stays at least
+    // MIN_BLOCK ints within the budget. With more runs than that, groups
+    // of fan_in are merged into longer runs in a second file first. Each
+    // merged group covers the same ints its runs did, so the run table
+    // keeps every fan_in-th start. A budget too small for even two runs
+    // (under 6 * MIN_BLOCK ints) still merges pairs, over the budget.
+    int fan_in = (int)(memory / (2 * MIN_BLOCK * (long)sizeof(int))) - 1;
+    if (fan_in < 2) fan_in = 2;
+    int passes = 0;
+    long total = (status == 0) ? run_start[k] : 0;
+    int first_runs = k;
+
+    while (status == 0 && k > fan_in) {
+        int next_fd = open(runs_path[1 - which], O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (next_fd < 0) {
+            perror(runs_path[1 - which]);
+            status = -1;
+            break;
+        }
+        int groups = (k + fan_in - 1) / fan_in;
+        for (int g = 0; g < groups && status == 0; g++) {
+            int first = g * fan_in;
+            int count = (k - first < fan_in) ? k - first : fan_in;
+            status = merge_runs(runs_fd, run_start + first, count, next_fd, merge_block(memory, count));
+            run_start[g] = run_start[first];   // only later groups read past first
+        }
+        run_start[groups] = total;
+        k = groups;
+        close(runs_fd);
+        unlink(runs_path[which]);
+        runs_fd = next_fd;
+        which = 1 - which;
+        passes++;
+    }
+
+    long block = merge_block(memory, k > 0 ? k : 1);
+    if (status == 0 && k > 0)
+        status = merge_runs(runs_fd, run_start, k, out_fd, block);
+    io_shutdown();
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    close(in_fd);
+    close(runs_fd);
+    close(out_fd);
+    unlink(runs_path[0]);
+    unlink(runs_path[1]);
+    free(run_start);
+
+    if (status != 0) {
+        fprintf(stderr, "External sort failed; removed %s and its run files\n", argv[2]);
+        unlink(argv[2]);
+        return 1;
+    }
+
+    double mb = total * sizeof(int) / (1024.0 * 1024.0);
+    double t1 = elapsed_ms(start, mid), t2 = elapsed_ms(mid, end);
+    printf("External Sort: %.1f MB, %d runs, %d intermediate merge pass(es), merge block %ld ints\n",
+           mb, first_runs, passes, block);
+    printf("Run formation: %.3f ms (%.1f MB/s)\n", t1, mb / (t1 / 1000.0));
+    printf("Merge: %.3f ms (%.1f MB/s)\n", t2, mb / (t2 / 1000.0));
+    return 0;
+}
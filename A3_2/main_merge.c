@@ -1,4 +1,118 @@
 #include "p_merge.h"
+#include <string.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+// Counts branch mispredictions of this thread in user space; -1 where
+// perf events are not permitted (see /proc/sys/kernel/perf_event_paranoid)
+int open_branch_miss_counter(void)
+{
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.size = sizeof(attr);
+    attr.config = PERF_COUNT_HW_BRANCH_MISSES;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    return (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+// 128-byte records for the key-index sort: seq is the original position,
+// so equal keys must come out with seq increasing
+typedef struct {
+    int key;
+    int seq;
+    char payload[120];
+} record_t;
+
+int record_key(const void* r) { return ((const record_t*)r)->key; }
+
+// Sort on the high bits only, with the full key breaking prefix ties
+int record_key_prefix(const void* r) { return ((const record_t*)r)->key >> 4; }
+
+int record_cmp_key(const void* a, const void* b) {
+    int x = ((const record_t*)a)->key, y = ((const record_t*)b)->key;
+    return (x > y) - (x < y);
+}
+
+// Counts records out of key order, out of seq order among equal keys,
+// or with a payload that no longer matches their seq
+long check_records(const record_t* recs, int n) {
+    long errors = 0;
+    for (int i = 0; i < n; i++) {
+        if (recs[i].payload[0] != (char)recs[i].seq) errors++;
+        if (i > 0 && (recs[i].key < recs[i - 1].key ||
+                      (recs[i].key == recs[i - 1].key && recs[i].seq < recs[i - 1].seq)))
+            errors++;
+    }
+    return errors;
+}
+
+void key_index_sort_demo(void)
+{
+    struct timespec start, end;
+    int n = SIZE;
+    record_t* recs = (record_t*)malloc((size_t)n * sizeof(record_t));
+    record_t* copy = (record_t*)malloc((size_t)n * sizeof(record_t));
+    unsigned int* perm = (unsigned int*)malloc((size_t)n * sizeof(unsigned int));
+    char* seen = (char*)calloc(n, 1);
+    if (!recs || !copy || !perm || !seen) {
+        printf("Memory allocation failed!\n");
+        free(recs); free(copy); free(perm); free(seen);
+        return;
+    }
+
+    // Few distinct keys, so stability is actually exercised
+    for (int i = 0; i < n; i++) {
+        recs[i].key = rand() % 1000 - 500;
+        recs[i].seq = i;
+        memset(recs[i].payload, (char)i, sizeof(recs[i].payload));
+    }
+    memcpy(copy, recs, (size_t)n * sizeof(record_t));
+
+    // Permutation: must be one, and must list equal keys in input order
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    key_index_sort_perm(recs, n, sizeof(record_t), record_key, NULL, perm, 4);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    long perm_errors = 0;
+    for (int i = 0; i < n; i++) {
+        if (perm[i] >= (unsigned int)n || seen[perm[i]]++) {
+            perm_errors++;
+            continue;
+        }
+        if (i > 0 && perm[i - 1] < (unsigned int)n) {
+            const record_t* a = &recs[perm[i - 1]];
+            const record_t* b = &recs[perm[i]];
+            if (b->key < a->key || (b->key == a->key && perm[i] < perm[i - 1]))
+                perm_errors++;
+        }
+    }
+    printf("Key-Index Sort Permutation Time (%d x %zu-byte records): %.3f ms, %s\n",
+           n, sizeof(record_t), time_diff_ms(start, end), perm_errors ? "FAILED" : "stable permutation");
+
+    // In place: records sorted by key, equal keys in seq order, payloads intact
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    key_index_sort(recs, n, sizeof(record_t), record_key, NULL, 4);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    printf("Key-Index Sort Time (in place): %.3f ms, %s\n",
+           time_diff_ms(start, end), check_records(recs, n) ? "FAILED" : "sorted and stable");
+
+    // Key prefix plus tie comparator must give the same order
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    key_index_sort(copy, n, sizeof(record_t), record_key_prefix, record_cmp_key, 4);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    printf("Key-Index Sort Time (key prefix + comparator): %.3f ms, %s\n",
+           time_diff_ms(start, end),
+           check_records(copy, n) || memcmp(copy, recs, (size_t)n * sizeof(record_t)) ? "FAILED" : "sorted and stable");
+
+    free(recs);
+    free(copy);
+    free(perm);
+    free(seen);
+}
 
 int main() 
 {
@@ -6,6 +120,10 @@ int main()
 
     int* arr1 = (int*)malloc(SIZE * sizeof(int));
     int* arr2 = (int*)malloc(SIZE * sizeof(int));
+    int* arr3 = (int*)malloc(SIZE * sizeof(int));
+    int* arr4 = (int*)malloc(SIZE * sizeof(int));
+    int* arr5 = (int*)malloc(SIZE * sizeof(int));
+    int* input = (int*)malloc(SIZE * sizeof(int));
 
     printf("Enter elements: ");
 
@@ -14,12 +132,30 @@ int main()
         int val = rand() % MAX_VAL;
         arr1[i] = val;
         arr2[i] = val;
+        arr3[i] = val;
+        arr4[i] = val;
+        arr5[i] = val;
+        input[i] = val;
     }
 
+    int counter = open_branch_miss_counter();
+    long long branch_misses = -1;
+    if (counter >= 0) {
+        ioctl(counter, PERF_EVENT_IOC_RESET, 0);
+        ioctl(counter, PERF_EVENT_IOC_ENABLE, 0);
+    }
     clock_gettime(CLOCK_MONOTONIC, &start);
     merge_sort_seq(arr1, 0, SIZE - 1);
     clock_gettime(CLOCK_MONOTONIC, &end);
+    if (counter >= 0) {
+        ioctl(counter, PERF_EVENT_IOC_DISABLE, 0);
+        if (read(counter, &branch_misses, sizeof(branch_misses)) != sizeof(branch_misses))
+            branch_misses = -1;
+        close(counter);
+    }
     printf("Sequential Merge Sort Time: %.3f ms\n", time_diff_ms(start, end));
+    if (branch_misses >= 0)
+        printf("Sequential Merge Sort Branch Misses: %lld\n", branch_misses);
     printArray(arr1, SIZE);
 
 
@@ -29,8 +165,79 @@ int main()
     printf("Parallel Merge Sort Time: %.3f ms\n", time_diff_ms(start, end));
     printArray(arr2, SIZE);
 
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    radix_sort_p(arr3, 0, SIZE - 1, 4);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    printf("Parallel Radix Sort Time: %.3f ms\n", time_diff_ms(start, end));
+    for (int i = 0; i < SIZE; i++) {
+        if (arr3[i] != arr1[i]) {
+            printf("Radix sort mismatch at %d\n", i);
+            break;
+        }
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    sample_sort_p(arr4, 0, SIZE - 1, 4);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    printf("Parallel Sample Sort Time: %.3f ms\n", time_diff_ms(start, end));
+    for (int i = 0; i < SIZE; i++) {
+        if (arr4[i] != arr1[i]) {
+            printf("Sample sort mismatch at %d\n", i);
+            break;
+        }
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    tim_sort_p(arr5, 0, SIZE - 1, 4);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    printf("Parallel TimSort Time: %.3f ms\n", time_diff_ms(start, end));
+    for (int i = 0; i < SIZE; i++) {
+        if (arr5[i] != arr1[i]) {
+            printf("TimSort mismatch at %d\n", i);
+            break;
+        }
+    }
+
+    // Same random data, sorted with O(sqrt(n)) extra memory
+    for (int i = 0; i < SIZE; i++) {
+        arr3[i] = input[i];
+        arr4[i] = input[i];
+    }
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    inplace_merge_sort_p(arr4, 0, SIZE - 1, 4);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    printf("Parallel In-Place Merge Sort Time: %.3f ms\n", time_diff_ms(start, end));
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    merge_sort_p(arr3, 0, SIZE - 1);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    printf("Parallel Merge Sort Time (same input, O(n) buffer): %.3f ms\n", time_diff_ms(start, end));
+    for (int i = 0; i < SIZE; i++) {
+        if (arr4[i] != arr1[i]) {
+            printf("In-place merge sort mismatch at %d\n", i);
+            break;
+        }
+    }
+
+    // Already sorted input: one natural run for TimSort, every pass
+    // still runs for the fixed-shape merge sort
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    merge_sort_seq(arr1, 0, SIZE - 1);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    printf("Sequential Merge Sort Time (sorted input): %.3f ms\n", time_diff_ms(start, end));
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    tim_sort(arr5, 0, SIZE - 1);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    printf("TimSort Time (sorted input): %.3f ms\n", time_diff_ms(start, end));
+
+    key_index_sort_demo();
+
     free(arr1);
     free(arr2);
+    free(arr3);
+    free(arr4);
+    free(arr5);
+    free(input);
 
     return 0;
 }
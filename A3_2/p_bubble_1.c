@@ -3,18 +3,26 @@
 #include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <time.h>
 
 #define NUM_THREADS 1
 #define SIZE 100000
 #define MAX_VAL 100000  // max random number
+#define CHECK_THREADS 8  // block version is also checked with 2 .. this many threads
+#define MAX_THREADS (NUM_THREADS > CHECK_THREADS ? NUM_THREADS : CHECK_THREADS)
 
 int array[SIZE];
+int scratch[SIZE];  // second buffer for the block version
 pthread_barrier_t barrier;
 
 typedef struct {
+    int id;
     int start, end;
 } ThreadData;
 
+ThreadData tdata[MAX_THREADS];
+int num_threads = NUM_THREADS;  // threads run_sort starts
+
 void printArray() 
 {
     for (int i = 0; i < SIZE; i++) 
@@ -52,30 +60,156 @@ void *parallel_bubble(void *arg)
     return NULL;
 }
 
-int main() 
+// BLOCK VERSION: sort each chunk once, then odd-even phases in which
+// neighbouring chunks merge and split (the lower thread keeps the smaller
+// half). One barrier per phase instead of one per element. num_threads
+// phases sort equal chunks; chunk sizes here differ by one when SIZE
+// doesn't divide evenly, so from then on each phase also checks every
+// chunk boundary and the sort stops once all of them are in order.
+
+int block_phases;                          // phases the last block sort took
+int boundary_unsorted[2][MAX_THREADS];     // per chunk: last > next chunk's first
+
+int compare_ints(const void *a, const void *b)
 {
-    for (int i = 0; i < SIZE; i++)
-        array[i] = rand() % MAX_VAL;
+    int x = *(const int *)a, y = *(const int *)b;
+    return (x > y) - (x < y);
+}
 
-    printf("Unsorted: ");
-//    printArray();
+void *parallel_block_bubble(void *arg) 
+{
+    ThreadData *data = (ThreadData *)arg;
+    int start = data->start;
+    int end = data->end;
 
-    pthread_t threads[NUM_THREADS];
-    ThreadData tdata[NUM_THREADS];
-    pthread_barrier_init(&barrier, NULL, NUM_THREADS);
+    qsort(array + start, end - start, sizeof(int), compare_ints);
+    pthread_barrier_wait(&barrier);
+
+    // Each phase reads src and writes only this chunk of dst
+    int *src = array, *dst = scratch;
+    for (int phase = 0;; phase++) {
+        int partner = (data->id % 2 == phase % 2) ? data->id + 1 : data->id - 1;
+
+        if (partner < 0 || partner >= num_threads) {
+            for (int i = start; i < end; i++)
+                dst[i] = src[i];
+        } else if (partner > data->id) {
+            // smallest end - start of the two chunks, from the front
+            int i = start, j = tdata[partner].start, pend = tdata[partner].end;
+            for (int k = start; k < end; k++)
+                dst[k] = (j >= pend || (i < end && src[i] <= src[j])) ? src[i++] : src[j++];
+        } else {
+            // largest end - start of the two chunks, from the back
+            int i = end - 1, j = tdata[partner].end - 1, pstart = tdata[partner].start;
+            for (int k = end - 1; k >= start; k--)
+                dst[k] = (j < pstart || (i >= start && src[i] > src[j])) ? src[i--] : src[j--];
+        }
 
-    int chunk_size = SIZE / NUM_THREADS;
-    for (int i = 0; i < NUM_THREADS; i++) {
-        tdata[i].start = i * chunk_size;
-        tdata[i].end = (i == NUM_THREADS - 1) ? SIZE : (i + 1) * chunk_size;
-        pthread_create(&threads[i], NULL, parallel_bubble, &tdata[i]);
+        pthread_barrier_wait(&barrier);
+        int *tmp = src; src = dst; dst = tmp;
+
+        if (phase + 1 >= num_threads) {
+            // Flags alternate by phase, so nobody can overwrite a set
+            // before every thread has read it
+            int *flags = boundary_unsorted[phase % 2];
+            flags[data->id] = end < SIZE && src[end - 1] > src[end];
+            pthread_barrier_wait(&barrier);
+            int done = 1;
+            for (int t = 0; t < num_threads; t++)
+                if (flags[t]) done = 0;
+            if (done) {
+                if (data->id == 0) block_phases = phase + 1;
+                break;
+            }
+        }
     }
 
-    for (int i = 0; i < NUM_THREADS; i++)
+    if (src != array)
+        for (int i = start; i < end; i++)
+            array[i] = src[i];
+
+    return NULL;
+}
+
+double run_sort(void *(*worker)(void *))
+{
+    struct timespec t0, t1;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+
+    pthread_t threads[MAX_THREADS];
+    pthread_barrier_init(&barrier, NULL, num_threads);
+
+    // Chunk sizes differ by at most one
+    for (int i = 0; i < num_threads; i++) {
+        tdata[i].id = i;
+        tdata[i].start = (int)((long)SIZE * i / num_threads);
+        tdata[i].end = (int)((long)SIZE * (i + 1) / num_threads);
+        pthread_create(&threads[i], NULL, worker, &tdata[i]);
+    }
+
+    for (int i = 0; i < num_threads; i++)
         pthread_join(threads[i], NULL);
 
     pthread_barrier_destroy(&barrier);
 
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    return (t1.tv_sec - t0.tv_sec) * 1000.0 + (t1.tv_nsec - t0.tv_nsec) / 1000000.0;
+}
+
+int is_sorted()
+{
+    for (int i = 1; i < SIZE; i++)
+        if (array[i - 1] > array[i])
+            return 0;
+    return 1;
+}
+
+int main() 
+{
+    static int original[SIZE];
+    for (int i = 0; i < SIZE; i++)
+        original[i] = rand() % MAX_VAL;
+
+    printf("Unsorted: ");
+//    printArray();
+
+    for (int i = 0; i < SIZE; i++)
+        array[i] = original[i];
+    double element_time = run_sort(parallel_bubble);
+    printf("\nBubble, barrier per pass: %.3f ms, %d barriers, %s\n",
+           element_time, SIZE - 1, is_sorted() ? "sorted" : "NOT sorted");
+
+    for (int i = 0; i < SIZE; i++)
+        array[i] = original[i];
+    double block_time = run_sort(parallel_block_bubble);
+    printf("Block merge-split:        %.3f ms, %d phases, %s\n",
+           block_time, block_phases, is_sorted() ? "sorted" : "NOT sorted");
+
+    // Reversed and random input on every thread count up to CHECK_THREADS,
+    // most of which split SIZE unevenly
+    int failures = 0;
+    for (num_threads = 2; num_threads <= CHECK_THREADS; num_threads++) {
+        for (int i = 0; i < SIZE; i++)
+            array[i] = SIZE - i;
+        run_sort(parallel_block_bubble);
+        int reversed_ok = is_sorted();
+        int reversed_phases = block_phases;
+
+        for (int i = 0; i < SIZE; i++)
+            array[i] = original[i];
+        run_sort(parallel_block_bubble);
+        int random_ok = is_sorted();
+        if (!reversed_ok || !random_ok) {
+            printf("Block merge-split with %d threads (SIZE %% threads = %d): reversed %s (%d phases), random %s\n",
+                   num_threads, SIZE % num_threads, reversed_ok ? "sorted" : "NOT sorted",
+                   reversed_phases, random_ok ? "sorted" : "NOT sorted");
+            failures++;
+        }
+    }
+    num_threads = NUM_THREADS;
+    printf("Block merge-split, 2-%d threads, reversed and random input: %s\n",
+           CHECK_THREADS, failures ? "FAILED" : "all sorted");
+
     printf("Sorted:   ");
 //    printArray();
 
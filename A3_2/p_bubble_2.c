@@ -8,9 +8,13 @@
 #define NUM_THREADS 1
 #define SIZE 100000
 #define MAX_VAL 100000  // max random number
+#define CHECK_THREADS 8  // block version is also checked with 2 .. this many threads
+#define MAX_THREADS (NUM_THREADS > CHECK_THREADS ? NUM_THREADS : CHECK_THREADS)
 
 int *array;
+int *scratch;  // second buffer for the block version
 int array_size;
+int num_threads = NUM_THREADS;  // threads run_sort starts
 pthread_barrier_t barrier;
 
 void printArray(int* arr, int n) 
@@ -55,32 +59,120 @@ void *parallel_odd_even(void *arg)
     return NULL;
 }
 
-int main() 
+// BLOCK ODD-EVEN MERGE-SPLIT: each thread sorts its own block once, then
+// phases of odd-even transposition between neighbouring blocks. In a
+// phase the lower thread of a pair keeps the smallest half of the two
+// blocks and the upper thread the largest, so only one barrier per phase
+// is needed instead of one per element. num_threads phases are enough for
+// equal blocks but not when their sizes differ by one, so from then on
+// every phase also checks the block boundaries and the sort stops once
+// they are all in order.
+
+int block_phases;                        // phases the last block sort took
+int boundary_unsorted[2][MAX_THREADS];   // per block: last > next block's first
+
+int compare_ints(const void *a, const void *b)
 {
-    srand(time(NULL));
-    array_size = SIZE;
-    array = malloc(array_size * sizeof(int));
-    if (!array) {
-        perror("malloc failed");
-        exit(EXIT_FAILURE);
+    int x = *(const int *)a, y = *(const int *)b;
+    return (x > y) - (x < y);
+}
+
+// The count smallest of sorted x[] and y[], in order, into out
+void merge_low(const int *x, int nx, const int *y, int ny, int *out, int count)
+{
+    int i = 0, j = 0;
+    for (int k = 0; k < count; k++) {
+        if (j >= ny || (i < nx && x[i] <= y[j]))
+            out[k] = x[i++];
+        else
+            out[k] = y[j++];
     }
-/*
-    printf("Unsorted array: ");
-    for (int i = 0; i < SIZE; i++) {
-        array[i] = rand() % MAX_VAL;
-        printf("%d ", array[i]);
+}
+
+// The count largest of sorted x[] and y[], in order, into out
+void merge_high(const int *x, int nx, const int *y, int ny, int *out, int count)
+{
+    int i = nx - 1, j = ny - 1;
+    for (int k = count - 1; k >= 0; k--) {
+        if (j < 0 || (i >= 0 && x[i] > y[j]))
+            out[k] = x[i--];
+        else
+            out[k] = y[j--];
+    }
+}
+
+// Block sizes differ by at most one
+void block_bounds(long thread_id, int *start, int *end)
+{
+    *start = (int)((long)array_size * thread_id / num_threads);
+    *end = (int)((long)array_size * (thread_id + 1) / num_threads);
+}
+
+void *parallel_block_odd_even(void *arg) 
+{
+    long thread_id = *(long *)arg;
+    free(arg);
+
+    int start, end;
+    block_bounds(thread_id, &start, &end);
+    qsort(array + start, end - start, sizeof(int), compare_ints);
+    pthread_barrier_wait(&barrier);
+
+    // Each phase reads src and writes only our own block of dst
+    int *src = array, *dst = scratch;
+    for (int phase = 0;; ++phase) {
+        long partner = (thread_id % 2 == phase % 2) ? thread_id + 1 : thread_id - 1;
+
+        if (partner < 0 || partner >= num_threads) {
+            for (int i = start; i < end; i++)
+                dst[i] = src[i];
+        } else {
+            int pstart, pend;
+            block_bounds(partner, &pstart, &pend);
+            if (partner > thread_id)
+                merge_low(src + start, end - start, src + pstart, pend - pstart, dst + start, end - start);
+            else
+                merge_high(src + pstart, pend - pstart, src + start, end - start, dst + start, end - start);
+        }
+
+        pthread_barrier_wait(&barrier);
+        int *tmp = src; src = dst; dst = tmp;
+
+        if (phase + 1 >= num_threads) {
+            // Flags alternate by phase, so nobody can overwrite a set
+            // before every thread has read it
+            int *flags = boundary_unsorted[phase % 2];
+            flags[thread_id] = end < array_size && src[end - 1] > src[end];
+            pthread_barrier_wait(&barrier);
+            int done = 1;
+            for (int t = 0; t < num_threads; t++)
+                if (flags[t]) done = 0;
+            if (done) {
+                if (thread_id == 0) block_phases = phase + 1;
+                break;
+            }
+        }
     }
-    printf("\n");
-*/
 
-    if (pthread_barrier_init(&barrier, NULL, NUM_THREADS)) {
+    if (src != array)
+        for (int i = start; i < end; i++)
+            array[i] = src[i];
+
+    return NULL;
+}
+
+double run_sort(void *(*worker)(void *))
+{
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    if (pthread_barrier_init(&barrier, NULL, num_threads)) {
         perror("Barrier init failed");
-        free(array);
         exit(EXIT_FAILURE);
     }
 
-    pthread_t threads[NUM_THREADS];
-    for (long i = 0; i < NUM_THREADS; i++) {
+    pthread_t threads[MAX_THREADS];
+    for (long i = 0; i < num_threads; i++) {
         long *tid = malloc(sizeof(long));
         if (!tid) 
         { 
@@ -88,20 +180,100 @@ int main()
             exit(EXIT_FAILURE); 
         }
         *tid = i;
-        if (pthread_create(&threads[i], NULL, parallel_odd_even, tid) != 0) {
+        if (pthread_create(&threads[i], NULL, worker, tid) != 0) {
             perror("pthread_create failed");
             exit(EXIT_FAILURE);
         }
     }
 
-    for (int i = 0; i < NUM_THREADS; i++)
+    for (int i = 0; i < num_threads; i++)
         pthread_join(threads[i], NULL);
 
     pthread_barrier_destroy(&barrier);
 
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    return (end.tv_sec - start.tv_sec) * 1000.0 + (end.tv_nsec - start.tv_nsec) / 1000000.0;
+}
+
+int is_sorted(const int *arr, int n)
+{
+    for (int i = 1; i < n; i++)
+        if (arr[i - 1] > arr[i])
+            return 0;
+    return 1;
+}
+
+int main() 
+{
+    srand(time(NULL));
+    array_size = SIZE;
+    array = malloc(array_size * sizeof(int));
+    if (!array) {
+        perror("malloc failed");
+        exit(EXIT_FAILURE);
+    }
+/*
+    printf("Unsorted array: ");
+    for (int i = 0; i < SIZE; i++) {
+        array[i] = rand() % MAX_VAL;
+        printf("%d ", array[i]);
+    }
+    printf("\n");
+*/
+
+    int *original = malloc(array_size * sizeof(int));
+    scratch = malloc(array_size * sizeof(int));
+    if (!original || !scratch) {
+        perror("malloc failed");
+        exit(EXIT_FAILURE);
+    }
+    for (int i = 0; i < array_size; i++)
+        original[i] = rand() % MAX_VAL;
+
+    // Barrier after every element-level phase: array_size barriers
+    for (int i = 0; i < array_size; i++)
+        array[i] = original[i];
+    double element_time = run_sort(parallel_odd_even);
+    printf("Odd-even, barrier per phase: %.3f ms, %d barriers, %s\n",
+           element_time, array_size, is_sorted(array, array_size) ? "sorted" : "NOT sorted");
+
+    // Block merge-split: one barrier per phase
+    for (int i = 0; i < array_size; i++)
+        array[i] = original[i];
+    double block_time = run_sort(parallel_block_odd_even);
+    printf("Block odd-even merge-split:  %.3f ms, %d phases, %s\n",
+           block_time, block_phases, is_sorted(array, array_size) ? "sorted" : "NOT sorted");
+
+    // Reversed and random input on every thread count up to CHECK_THREADS,
+    // most of which split the array unevenly
+    int failures = 0;
+    for (num_threads = 2; num_threads <= CHECK_THREADS; num_threads++) {
+        for (int i = 0; i < array_size; i++)
+            array[i] = array_size - i;
+        run_sort(parallel_block_odd_even);
+        int reversed_ok = is_sorted(array, array_size);
+        int reversed_phases = block_phases;
+
+        for (int i = 0; i < array_size; i++)
+            array[i] = original[i];
+        run_sort(parallel_block_odd_even);
+        int random_ok = is_sorted(array, array_size);
+        if (!reversed_ok || !random_ok) {
+            printf("Block merge-split with %d threads (size %% threads = %d): reversed %s (%d phases), random %s\n",
+                   num_threads, array_size % num_threads, reversed_ok ? "sorted" : "NOT sorted",
+                   reversed_phases, random_ok ? "sorted" : "NOT sorted");
+            failures++;
+        }
+    }
+    num_threads = NUM_THREADS;
+    printf("Block merge-split, 2-%d threads, reversed and random input: %s\n",
+           CHECK_THREADS, failures ? "FAILED" : "all sorted");
+
     printf("Sorted array:   ");
 //    printArray(array, SIZE);
 
     free(array);
+    free(scratch);
+    free(original);
     return 0;
 }
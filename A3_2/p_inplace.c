@@ -0,0 +1,209 @@
+// IN-PLACE STABLE MERGE SORT
+//
+// For arrays too big to double: instead of an n-element scratch array each
+// worker owns one buffer of about sqrt(n) ints. A merge whose shorter run
+// fits in that buffer goes through it as usual. Longer merges are split
+// the SymMerge way: take the middle of the longer run, binary-search where
+// it belongs in the other, and rotate the two inner pieces past each other.
+// That leaves two smaller merges that touch disjoint ranges, so they are
+// forked as separate tasks on the work-stealing pool. Ties always go to
+// the left run, so the sort is stable.
+//
+// Build: gcc ... p_inplace.c p_merge.c p_sortnet.c ../common/workstealing.c -lpthread
+
+#include "p_merge.h"
+#include "../common/workstealing.h"
+#include <string.h>
+
+#define IP_SORT_GRAIN 8192    // subarrays sorted by a single task
+#define IP_MERGE_GRAIN 16384  // merges no longer than this are not split into tasks
+
+typedef struct {
+    int* arr;
+    int l, m, r;        // half-open runs [l, m) and [m, r); m unused by sort tasks
+    int* buffers;       // num_workers * buf_len ints
+    int buf_len;
+} ip_args_t;
+
+// The calling worker's buffer. Only used between spawns and syncs, so no
+// other task can be running on the same worker meanwhile.
+static int* worker_buffer(const ip_args_t* a) {
+    int w = ws_worker_id();
+    return a->buffers + (long)(w < 0 ? 0 : w) * a->buf_len;
+}
+
+static void reverse_range(int* arr, int lo, int hi) {
+    for (hi--; lo < hi; lo++, hi--) {
+        int t = arr[lo]; arr[lo] = arr[hi]; arr[hi] = t;
+    }
+}
+
+// Swap the blocks [first, middle) and [middle, last): through the buffer
+// when the smaller block fits, else by three reversals
+static void rotate(int* arr, int first, int middle, int last, int* buf, int buf_len) {
+    int n1 = middle - first, n2 = last - middle;
+    if (n1 == 0 || n2 == 0) return;
+    if (n1 <= buf_len && n1 <= n2) {
+        memcpy(buf, arr + first, n1 * sizeof(int));
+        memmove(arr + first, arr + middle, n2 * sizeof(int));
+        memcpy(arr + first + n2, buf, n1 * sizeof(int));
+    } else if (n2 <= buf_len) {
+        memcpy(buf, arr + middle, n2 * sizeof(int));
+        memmove(arr + first + n2, arr + first, n1 * sizeof(int));
+        memcpy(arr + first, buf, n2 * sizeof(int));
+    } else {
+        reverse_range(arr, first, middle);
+        reverse_range(arr, middle, last);
+        reverse_range(arr, first, last);
+    }
+}
+
+// First index in [lo, hi) with arr[i] >= key (lower) or > key (upper)
+static int lower_bound(const int* arr, int lo, int hi, int key) {
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (arr[mid] < key) lo = mid + 1; else hi = mid;
+    }
+    return lo;
+}
+
+static int upper_bound(const int* arr, int lo, int hi, int key) {
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (arr[mid] <= key) lo = mid + 1; else hi = mid;
+    }
+    return lo;
+}
+
+// One SymMerge step on [l, m) and [m, r): afterwards [l, *split) and
+// [*split, r) are independent merges, with runs ending at *m1 and *m2
+static void split_merge(int* arr, int l, int m, int r, int* buf, int buf_len,
+                        int* m1, int* split, int* m2) {
+    int c1, c2;
+    if (m - l >= r - m) {
+        c1 = l + (m - l) / 2;
+        c2 = lower_bound(arr, m, r, arr[c1]);
+    } else {
+        c2 = m + (r - m) / 2;
+        c1 = upper_bound(arr, l, m, arr[c2]);
+    }
+    rotate(arr, c1, m, c2, buf, buf_len);
+    *m1 = c1;
+    *split = c1 + (c2 - m);
+    *m2 = c2;
+}
+
+// Sequential merge of [l, m) and [m, r) using at most buf_len extra ints
+static void ip_merge_seq(int* arr, int l, int m, int r, int* buf, int buf_len) {
+    while (l < m && m < r && arr[m - 1] > arr[m]) {
+        int n1 = m - l, n2 = r - m;
+
+        if (n1 <= buf_len) {
+            memcpy(buf, arr + l, n1 * sizeof(int));
+            merge_branchless(buf, n1, arr + m, n2, arr + l);
+            return;
+        }
+        if (n2 <= buf_len) {
+            // copy the right run out and merge from the back
+            memcpy(buf, arr + m, n2 * sizeof(int));
+            int i = m - 1, j = n2 - 1, k = r - 1;
+            while (i >= l && j >= 0)
+                arr[k--] = (buf[j] < arr[i]) ? arr[i--] : buf[j--];
+            while (j >= 0)
+                arr[k--] = buf[j--];
+            return;
+        }
+
+        // recurse into the smaller half, loop on the larger one
+        int m1, split, m2;
+        split_merge(arr, l, m, r, buf, buf_len, &m1, &split, &m2);
+        if (split - l < r - split) {
+            ip_merge_seq(arr, l, m1, split, buf, buf_len);
+            l = split; m = m2;
+        } else {
+            ip_merge_seq(arr, split, m2, r, buf, buf_len);
+            r = split; m = m1;
+        }
+    }
+}
+
+// Bottom-up: sort_block the SORT_BLOCK pieces, then merge widths doubling
+static void ip_sort_seq(int* arr, int l, int r, int* buf, int buf_len) {
+    for (int lo = l; lo < r; lo += SORT_BLOCK)
+        sort_block(arr + lo, (r - lo < SORT_BLOCK) ? r - lo : SORT_BLOCK);
+    for (int width = SORT_BLOCK; width < r - l; width *= 2)
+        for (int lo = l; lo + width < r; lo += 2 * width) {
+            int hi = (r - lo > 2 * width) ? lo + 2 * width : r;
+            ip_merge_seq(arr, lo, lo + width, hi, buf, buf_len);
+        }
+}
+
+static void ip_merge_task(void* arg) {
+    ip_args_t* a = (ip_args_t*)arg;
+    if (a->l == a->m || a->m == a->r || a->arr[a->m - 1] <= a->arr[a->m]) return;
+    if (a->r - a->l <= IP_MERGE_GRAIN || a->m - a->l <= a->buf_len || a->r - a->m <= a->buf_len) {
+        ip_merge_seq(a->arr, a->l, a->m, a->r, worker_buffer(a), a->buf_len);
+        return;
+    }
+
+    int m1, split, m2;
+    split_merge(a->arr, a->l, a->m, a->r, worker_buffer(a), a->buf_len, &m1, &split, &m2);
+    ip_args_t left = {a->arr, a->l, m1, split, a->buffers, a->buf_len};
+    ip_args_t right = {a->arr, split, m2, a->r, a->buffers, a->buf_len};
+    ws_spawn(ip_merge_task, &left, sizeof(left));
+    ip_merge_task(&right);
+    ws_sync();
+}
+
+static void ip_sort_task(void* arg) {
+    ip_args_t* a = (ip_args_t*)arg;
+    if (a->r - a->l <= IP_SORT_GRAIN) {
+        ip_sort_seq(a->arr, a->l, a->r, worker_buffer(a), a->buf_len);
+        return;
+    }
+
+    int m = a->l + (a->r - a->l) / 2;
+    ip_args_t left = {a->arr, a->l, 0, m, a->buffers, a->buf_len};
+    ip_args_t right = {a->arr, m, 0, a->r, a->buffers, a->buf_len};
+    ws_spawn(ip_sort_task, &left, sizeof(left));
+    ip_sort_task(&right);
+    ws_sync();
+
+    ip_args_t merge_args = {a->arr, a->l, m, a->r, a->buffers, a->buf_len};
+    ip_merge_task(&merge_args);
+}
+
+// ceil(sqrt(n)), but at least SORT_BLOCK
+static int buffer_length(int n) {
+    int len = SORT_BLOCK;
+    while ((long)len * len < n) len++;
+    return len;
+}
+
+void inplace_merge_sort(int* arr, int l, int r) {
+    int n = r - l + 1;
+    if (n < 2) return;
+    int buf_len = buffer_length(n);
+    int* buf = (int*)malloc(buf_len * sizeof(int));
+    ip_sort_seq(arr, l, r + 1, buf, buf_len);
+    free(buf);
+}
+
+void inplace_merge_sort_p(int* arr, int l, int r, int num_threads) {
+    int n = r - l + 1;
+    if (n < 2) return;
+    if (num_threads < 2 || n <= IP_SORT_GRAIN) {
+        inplace_merge_sort(arr, l, r);
+        return;
+    }
+
+    int buf_len = buffer_length(n);
+    int* buffers = (int*)malloc((long)num_threads * buf_len * sizeof(int));
+    ws_pool_t* pool = ws_create(num_threads);
+
+    ip_args_t args = {arr, l, 0, r + 1, buffers, buf_len};
+    ws_run(pool, ip_sort_task, &args, sizeof(args));
+
+    ws_destroy(pool);
+    free(buffers);
+}
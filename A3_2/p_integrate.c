@@ -1,9 +1,12 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <pthread.h>
+#include "../common/workstealing.h"
 
 #define N 1000000000 // intervals
 #define NUM_THREADS 4
+#define USE_WORK_STEALING 1  // 0: one fixed chunk per pthread
+#define GRAIN 1000000        // intervals per leaf task
 
 double f(double x) {
     return 4.0 / (1.0 + x * x);
@@ -20,19 +23,25 @@ typedef struct {
     double step;
 } thread_data_t;
 
-void *parallel_trapezoidalRule(void *arg) 
+double trapezoid_sum(long start, long end, double step)
 {
-    thread_data_t *data = (thread_data_t *)arg;
-    long start = data->start;
-    long end = data->end;
-    double step = data->step;
-
     double local_sum = 0.0;
     for (long i = start; i < end; i++) {
         double x1 = i * step;
         double x2 = (i + 1) * step;
         local_sum += 0.5 * (f(x1) + f(x2)) * step;
     }
+    return local_sum;
+}
+
+void *parallel_trapezoidalRule(void *arg) 
+{
+    thread_data_t *data = (thread_data_t *)arg;
+    long start = data->start;
+    long end = data->end;
+    double step = data->step;
+
+    double local_sum = trapezoid_sum(start, end, step);
 
     pthread_mutex_lock(&mutex);
     total_sum += local_sum;
@@ -41,8 +50,46 @@ void *parallel_trapezoidalRule(void *arg)
     pthread_exit(NULL);
 }
 
+// Work-stealing version: split the range in half until it is GRAIN long,
+// and let each worker add its leaves into its own slot (no mutex)
+double worker_sums[NUM_THREADS];
+
+typedef struct {
+    long start;
+    long end;
+    double step;
+} range_t;
+
+void ws_trapezoidalRule(void *arg)
+{
+    range_t *r = (range_t *)arg;
+    if (r->end - r->start <= GRAIN) {
+        worker_sums[ws_worker_id()] += trapezoid_sum(r->start, r->end, r->step);
+        return;
+    }
+
+    long mid = r->start + (r->end - r->start) / 2;
+    range_t left = {r->start, mid, r->step};
+    range_t right = {mid, r->end, r->step};
+    ws_spawn(ws_trapezoidalRule, &left, sizeof(left));
+    ws_trapezoidalRule(&right);
+}
+
 int main(int argc, char *argv[]) 
 {
+    if (USE_WORK_STEALING) {
+        ws_pool_t *pool = ws_create(NUM_THREADS);
+        range_t all = {0, N, 1.0 / (double)N};
+        ws_run(pool, ws_trapezoidalRule, &all, sizeof(all));
+        ws_destroy(pool);
+
+        for (int i = 0; i < NUM_THREADS; i++)
+            total_sum += worker_sums[i];
+
+//        printf("Result of numerical integration: %f\n", total_sum);
+        return 0;
+    }
+
     pthread_t threads[NUM_THREADS];
     thread_data_t thread_data[NUM_THREADS];
     double step = 1.0 / (double)N;
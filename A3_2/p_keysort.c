@@ -0,0 +1,198 @@
+// KEY-INDEX SORT FOR ARRAYS OF RECORDS
+//
+// Records are never moved while sorting: each one contributes a 64-bit
+// pair (key << 32 | index), the pairs are radix sorted on the key half,
+// and the records are then gathered into place in one pass (or the
+// permutation is handed back). For 128-byte records that is 8 bytes of
+// traffic per element per pass instead of 128.
+
+#include "p_merge.h"
+#include <string.h>
+#include <stdint.h>
+#include <limits.h>
+
+#define PAIR_BITS 8   // digit width for the pair radix passes
+
+typedef struct {
+    int id;
+    int num_threads;
+    const char* records;
+    int n;
+    size_t elem_size;
+    record_key_fn key;
+    record_cmp_fn tie_cmp;     // NULL: keys are complete
+    uint64_t* pairs;
+    uint64_t* tmp;
+    unsigned int* minmax;      // 2 per thread
+    long* counts;              // num_threads rows of 1 << PAIR_BITS
+    unsigned int* perm;        // output permutation, or NULL
+    char* gathered;            // gather target, or NULL
+    pthread_barrier_t* barrier;
+} keysort_data_t;
+
+#define PAIR_KEY(p) ((unsigned int)((p) >> 32))
+#define PAIR_INDEX(p) ((unsigned int)(p))
+
+// Stable merge sort of one run of equal key prefixes with the full comparator
+static void sort_tied(uint64_t* a, uint64_t* buf, int n, const keysort_data_t* d) {
+    if (n < 16) {
+        for (int i = 1; i < n; i++) {
+            uint64_t x = a[i];
+            const char* rx = d->records + (size_t)PAIR_INDEX(x) * d->elem_size;
+            int j = i - 1;
+            while (j >= 0 && d->tie_cmp(d->records + (size_t)PAIR_INDEX(a[j]) * d->elem_size, rx) > 0) {
+                a[j + 1] = a[j];
+                j--;
+            }
+            a[j + 1] = x;
+        }
+        return;
+    }
+    int h = n / 2;
+    sort_tied(a, buf, h, d);
+    sort_tied(a + h, buf, n - h, d);
+    memcpy(buf, a, h * sizeof(uint64_t));
+    int i = 0, j = h, k = 0;
+    while (i < h && j < n) {
+        const char* ri = d->records + (size_t)PAIR_INDEX(buf[i]) * d->elem_size;
+        const char* rj = d->records + (size_t)PAIR_INDEX(a[j]) * d->elem_size;
+        a[k++] = (d->tie_cmp(rj, ri) < 0) ? a[j++] : buf[i++];
+    }
+    while (i < h) a[k++] = buf[i++];
+}
+
+void* keysort_worker(void* arg) {
+    keysort_data_t* d = (keysort_data_t*)arg;
+    int T = d->num_threads;
+    int start = (int)((long)d->n * d->id / T);
+    int end = (int)((long)d->n * (d->id + 1) / T);
+
+    // 1. Pairs. Flipping the sign bit makes signed keys compare as unsigned.
+    unsigned int lo = UINT_MAX, hi = 0;
+    for (int i = start; i < end; i++) {
+        unsigned int k = (unsigned int)d->key(d->records + (size_t)i * d->elem_size) ^ 0x80000000u;
+        d->pairs[i] = ((uint64_t)k << 32) | (unsigned int)i;
+        if (k < lo) lo = k;
+        if (k > hi) hi = k;
+    }
+    d->minmax[2 * d->id] = lo;
+    d->minmax[2 * d->id + 1] = hi;
+    pthread_barrier_wait(d->barrier);
+
+    // 2. LSD radix on (key - min), as many digits as the key range needs;
+    // every thread derives the same pass count from the shared minmax
+    unsigned int min = UINT_MAX, max = 0;
+    for (int t = 0; t < T; t++) {
+        if (d->minmax[2 * t] < min) min = d->minmax[2 * t];
+        if (d->minmax[2 * t + 1] > max) max = d->minmax[2 * t + 1];
+    }
+    int key_bits = (max > min) ? 32 - __builtin_clz(max - min) : 0;
+    int passes = (key_bits + PAIR_BITS - 1) / PAIR_BITS;
+    int buckets = 1 << PAIR_BITS;
+    long* my_counts = d->counts + (long)d->id * buckets;
+    long offset[1 << PAIR_BITS];
+
+    uint64_t* src = d->pairs;
+    uint64_t* dst = d->tmp;
+    for (int pass = 0; pass < passes; pass++) {
+        int shift = pass * PAIR_BITS;
+        for (int b = 0; b < buckets; b++) my_counts[b] = 0;
+        for (int i = start; i < end; i++)
+            my_counts[((PAIR_KEY(src[i]) - min) >> shift) & (buckets - 1)]++;
+        pthread_barrier_wait(d->barrier);
+
+        long base = 0;
+        for (int b = 0; b < buckets; b++)
+            for (int t = 0; t < T; t++) {
+                if (t == d->id) offset[b] = base;
+                base += d->counts[(long)t * buckets + b];
+            }
+        pthread_barrier_wait(d->barrier);
+
+        for (int i = start; i < end; i++)
+            dst[offset[((PAIR_KEY(src[i]) - min) >> shift) & (buckets - 1)]++] = src[i];
+        pthread_barrier_wait(d->barrier);
+
+        uint64_t* t = src; src = dst; dst = t;
+    }
+
+    // 3. Runs of equal prefixes go to the full comparator; a run belongs
+    // to the thread whose chunk it starts in
+    if (d->tie_cmp) {
+        int i = start;
+        if (i > 0)
+            while (i < end && PAIR_KEY(src[i]) == PAIR_KEY(src[i - 1])) i++;
+        pthread_barrier_wait(d->barrier);  // everyone has found their first run
+        while (i < end) {
+            int j = i + 1;
+            while (j < d->n && PAIR_KEY(src[j]) == PAIR_KEY(src[i])) j++;
+            if (j - i > 1) {
+                uint64_t* buf = (uint64_t*)malloc((j - i) / 2 * sizeof(uint64_t) + sizeof(uint64_t));
+                sort_tied(src + i, buf, j - i, d);
+                free(buf);
+            }
+            i = j;
+        }
+        pthread_barrier_wait(d->barrier);
+    }
+
+    // 4. Permutation out, or gather the records and copy them back
+    if (d->perm) {
+        for (int i = start; i < end; i++)
+            d->perm[i] = PAIR_INDEX(src[i]);
+    } else {
+        for (int i = start; i < end; i++)
+            memcpy(d->gathered + (size_t)i * d->elem_size,
+                   d->records + (size_t)PAIR_INDEX(src[i]) * d->elem_size, d->elem_size);
+        pthread_barrier_wait(d->barrier);
+        memcpy((char*)d->records + (size_t)start * d->elem_size,
+               d->gathered + (size_t)start * d->elem_size, (size_t)(end - start) * d->elem_size);
+    }
+    return NULL;
+}
+
+static void run_keysort(const void* records, int n, size_t elem_size, record_key_fn key,
+                        record_cmp_fn tie_cmp, unsigned int* perm, char* gathered, int num_threads) {
+    if (num_threads > n) num_threads = n;
+    if (num_threads < 1) num_threads = 1;
+
+    uint64_t* pairs = (uint64_t*)malloc((long)n * sizeof(uint64_t));
+    uint64_t* tmp = (uint64_t*)malloc((long)n * sizeof(uint64_t));
+    unsigned int* minmax = (unsigned int*)malloc(2 * num_threads * sizeof(unsigned int));
+    long* counts = (long*)malloc((long)num_threads * (1 << PAIR_BITS) * sizeof(long));
+    pthread_barrier_t barrier;
+    pthread_barrier_init(&barrier, NULL, num_threads);
+
+    pthread_t threads[num_threads];
+    keysort_data_t data[num_threads];
+    for (int t = 0; t < num_threads; t++) {
+        data[t] = (keysort_data_t){t, num_threads, (const char*)records, n, elem_size, key,
+                                   tie_cmp, pairs, tmp, minmax, counts, perm, gathered, &barrier};
+        pthread_create(&threads[t], NULL, keysort_worker, &data[t]);
+    }
+    for (int t = 0; t < num_threads; t++)
+        pthread_join(threads[t], NULL);
+
+    pthread_barrier_destroy(&barrier);
+    free(pairs);
+    free(tmp);
+    free(minmax);
+    free(counts);
+}
+
+// perm[i] = index of the record that belongs at position i. The sort is
+// stable; tie_cmp (may be NULL) orders records whose keys are equal.
+void key_index_sort_perm(const void* records, int n, size_t elem_size, record_key_fn key,
+                         record_cmp_fn tie_cmp, unsigned int* perm, int num_threads) {
+    if (n < 1) return;
+    run_keysort(records, n, elem_size, key, tie_cmp, perm, NULL, num_threads);
+}
+
+// Sort the records in place (through one n * elem_size gather buffer)
+void key_index_sort(void* records, int n, size_t elem_size, record_key_fn key,
+                    record_cmp_fn tie_cmp, int num_threads) {
+    if (n < 2) return;
+    char* gathered = (char*)malloc((size_t)n * elem_size);
+    run_keysort(records, n, elem_size, key, tie_cmp, NULL, gathered, num_threads);
+    free(gathered);
+}
@@ -1,41 +1,250 @@
 #include "p_merge.h"
+#include "../common/workstealing.h"
 #include <pthread.h>
 #include <unistd.h>
+#include <string.h>
 
 #define NUM_THREADS 4
 
-void merge(int* arr, int l, int m, int r) 
+void merge(int* arr, int l, int m, int r, int* L) 
 {
+    // Only the left run needs saving, in the caller's L (m - l + 1 ints):
+    // the write position never passes the unread part of the right run
     int n1 = m - l + 1;
-    int n2 = r - m;
-
-    int* L = (int*)malloc(n1 * sizeof(int));
-    int* R = (int*)malloc(n2 * sizeof(int));
-
     for (int i = 0; i < n1; i++) L[i] = arr[l + i];
-    for (int i = 0; i < n2; i++) R[i] = arr[m + 1 + i];
 
-    int i = 0, j = 0, k = l;
-    while (i < n1 && j < n2) {
-        if (L[i] <= R[j])
+    int i = 0, j = m + 1, k = l;
+    while (i < n1 && j <= r) {
+        if (L[i] <= arr[j])
             arr[k++] = L[i++];
         else
-            arr[k++] = R[j++];
+            arr[k++] = arr[j++];
     }
     while (i < n1) arr[k++] = L[i++];
-    while (j < n2) arr[k++] = R[j++];
+}
+
+void insertion_sort(int* arr, int l, int r) {
+    for (int i = l + 1; i <= r; i++) {
+        int key = arr[i];
+        int j = i - 1;
+        while (j >= l && arr[j] > key) {
+            arr[j + 1] = arr[j];
+            j--;
+        }
+        arr[j + 1] = key;
+    }
+}
 
-    free(L);
-    free(R);
+// Merge src[l..m] and src[m+1..r] into dst[l..r]. Runs produced by
+// merge_sort_buf are whole SORT_BLOCKs except at the very end, so nearly
+// every merge takes the vector kernel.
+static void merge_into(const int* src, int* dst, int l, int m, int r) {
+    int na = m - l + 1, nb = r - m;
+    if (nb == 0) {
+        for (int i = l; i <= r; i++) dst[i] = src[i];
+    } else if (na % 8 == 0 && nb % 8 == 0) {
+        merge_simd(src + l, na, src + m + 1, nb, dst + l);
+    } else {
+        merge_branchless(src + l, na, src + m + 1, nb, dst + l);
+    }
 }
 
+// Bottom-up merge sort of arr[0..n-1] with a caller-provided buffer of n
+// ints: blocks of SORT_BLOCK are sorted in place by the sorting network,
+// then each pass merges pairs of runs from one array into the other, so
+// nothing is allocated and no stack grows with n
+void merge_sort_buf(int* arr, int n, int* buf) {
+    for (int lo = 0; lo < n; lo += SORT_BLOCK)
+        sort_block(arr + lo, (lo + SORT_BLOCK < n) ? SORT_BLOCK : n - lo);
+
+    int* src = arr;
+    int* dst = buf;
+    for (int width = SORT_BLOCK; width < n; width *= 2) {
+        for (int lo = 0; lo < n; lo += 2 * width) {
+            int mid = (lo + width < n) ? lo + width - 1 : n - 1;
+            int hi = (lo + 2 * width < n) ? lo + 2 * width - 1 : n - 1;
+            merge_into(src, dst, lo, mid, hi);
+        }
+        int* t = src; src = dst; dst = t;
+    }
+
+    if (src != arr)
+        for (int i = 0; i < n; i++) arr[i] = src[i];
+}
+
+// Sequential base case for every parallel variant: one buffer per call
 void merge_sort_seq(int* arr, int l, int r) {
-    if (l < r) {
-        int m = (l + r) / 2;
-        merge_sort_seq(arr, l, m);
-        merge_sort_seq(arr, m + 1, r);
-        merge(arr, l, m, r);
+    int n = r - l + 1;
+    if (n < 2) return;
+    if (n <= SORT_BLOCK) {
+        sort_block(arr + l, n);
+        return;
+    }
+    int* buf = (int*)malloc(n * sizeof(int));
+    merge_sort_buf(arr + l, n, buf);
+    free(buf);
+}
+
+// ------------- Merge path: parallel two-way and k-way merges ---
+
+// How many of the first diag outputs of a stable merge of a and b come
+// from a (binary search along the diagonal of the merge matrix)
+int merge_path_split(const int* a, int na, const int* b, int nb, int diag) {
+    int lo = diag > nb ? diag - nb : 0;
+    int hi = diag < na ? diag : na;
+    while (lo < hi) {
+        int i = lo + (hi - lo) / 2;
+        if (a[i] <= b[diag - i - 1]) lo = i + 1;  // a wins ties: stable
+        else hi = i;
+    }
+    return lo;
+}
+
+// Write outputs d0 .. d1-1 of merging src[l..m] and src[m+1..r] to dst[l+d0 ..]
+void merge_path_chunk(const int* src, int l, int m, int r, int* dst, int d0, int d1) {
+    const int* a = src + l;
+    const int* b = src + m + 1;
+    int na = m - l + 1, nb = r - m;
+
+    int i = merge_path_split(a, na, b, nb, d0);
+    int j = d0 - i;
+    int iEnd = merge_path_split(a, na, b, nb, d1);
+    int jEnd = d1 - iEnd;
+
+    merge_branchless(a + i, iEnd - i, b + j, jEnd - j, dst + l + d0);
+}
+
+// Split output rank `rank` of a k-way merge into per-segment counts pos[s]
+// (segment s is arr[bounds[s] .. bounds[s+1]-1]). Elements below the
+// pivot value all go in; ties are taken from earlier segments first, so
+// the split is stable and consistent across ranks.
+void kway_split(const int* arr, const int* bounds, int k, long rank, int* pos) {
+    long lo = -2147483648L, hi = 2147483647L;
+
+    // smallest value v with (count of elements <= v) >= rank
+    while (lo < hi) {
+        long v = lo + (hi - lo) / 2;
+        long count = 0;
+        for (int s = 0; s < k; s++) {
+            int a = bounds[s], b = bounds[s + 1];
+            while (a < b) {  // upper bound of v
+                int mid = a + (b - a) / 2;
+                if (arr[mid] <= v) a = mid + 1; else b = mid;
+            }
+            count += a - bounds[s];
+        }
+        if (count >= rank) hi = v; else lo = v + 1;
+    }
+
+    long taken = 0;
+    int* eq_end = (int*)malloc(k * sizeof(int));
+    for (int s = 0; s < k; s++) {
+        int a = bounds[s], b = bounds[s + 1];
+        while (a < b) {  // lower bound of the pivot
+            int mid = a + (b - a) / 2;
+            if (arr[mid] < lo) a = mid + 1; else b = mid;
+        }
+        pos[s] = a - bounds[s];
+        taken += pos[s];
+
+        b = bounds[s + 1];
+        int e = a;
+        while (e < b) {  // upper bound of the pivot
+            int mid = e + (b - e) / 2;
+            if (arr[mid] <= lo) e = mid + 1; else b = mid;
+        }
+        eq_end[s] = e - bounds[s];
+    }
+    for (int s = 0; s < k && taken < rank; s++) {
+        long extra = eq_end[s] - pos[s];
+        if (extra > rank - taken) extra = rank - taken;
+        pos[s] += extra;
+        taken += extra;
+    }
+    free(eq_end);
+}
+
+typedef struct {
+    int* arr;
+    int* tmp;
+    const int* bounds;  // k-way only
+    int k;              // k-way only; 0 for a two-way merge
+    int l, m, r;        // two-way only
+    int d0, d1;         // output ranks this thread produces
+    pthread_barrier_t* barrier;
+} merge_path_data_t;
+
+void* merge_path_worker(void* arg) {
+    merge_path_data_t* data = (merge_path_data_t*)arg;
+    int base;
+
+    if (data->k == 0) {
+        base = data->l;
+        merge_path_chunk(data->arr, data->l, data->m, data->r, data->tmp, data->d0, data->d1);
+    } else {
+        int k = data->k;
+        base = data->bounds[0];
+        int* cur = (int*)malloc(2 * k * sizeof(int));
+        int* end = cur + k;
+        kway_split(data->arr, data->bounds, k, data->d0, cur);
+        kway_split(data->arr, data->bounds, k, data->d1, end);
+        for (int s = 0; s < k; s++) {
+            cur[s] += data->bounds[s];
+            end[s] += data->bounds[s];
+        }
+
+        // k is the thread count, so a linear scan for the minimum is cheap
+        for (int out = base + data->d0; out < base + data->d1; out++) {
+            int best = -1;
+            for (int s = 0; s < k; s++)
+                if (cur[s] < end[s] && (best < 0 || data->arr[cur[s]] < data->arr[cur[best]]))
+                    best = s;
+            data->tmp[out] = data->arr[cur[best]++];
+        }
+        free(cur);
+    }
+
+    // nobody may overwrite arr until every thread has finished reading it
+    pthread_barrier_wait(data->barrier);
+    for (int i = base + data->d0; i < base + data->d1; i++)
+        data->arr[i] = data->tmp[i];
+    return NULL;
+}
+
+static void run_merge_path(merge_path_data_t proto, int total, int num_threads) {
+    pthread_t threads[num_threads];
+    merge_path_data_t data[num_threads];
+    pthread_barrier_t barrier;
+    pthread_barrier_init(&barrier, NULL, num_threads);
+
+    for (int t = 0; t < num_threads; t++) {
+        data[t] = proto;
+        data[t].d0 = (int)((long)total * t / num_threads);
+        data[t].d1 = (int)((long)total * (t + 1) / num_threads);
+        data[t].barrier = &barrier;
+        pthread_create(&threads[t], NULL, merge_path_worker, &data[t]);
     }
+    for (int t = 0; t < num_threads; t++)
+        pthread_join(threads[t], NULL);
+
+    pthread_barrier_destroy(&barrier);
+}
+
+// Merge arr[l..m] and arr[m+1..r] with every thread producing an equal
+// share of the output
+void merge_p(int* arr, int l, int m, int r, int num_threads) {
+    int* tmp = (int*)malloc((r + 1) * sizeof(int));
+    merge_path_data_t proto = {arr, tmp, NULL, 0, l, m, r, 0, 0, NULL};
+    run_merge_path(proto, r - l + 1, num_threads);
+    free(tmp);
+}
+
+// Merge k sorted segments arr[bounds[s] .. bounds[s+1]-1] in one pass
+void merge_p_kway(int* arr, const int* bounds, int k, int num_threads) {
+    int* tmp = (int*)malloc(bounds[k] * sizeof(int));
+    merge_path_data_t proto = {arr, tmp, bounds, k, 0, 0, 0, 0, 0, NULL};
+    run_merge_path(proto, bounds[k] - bounds[0], num_threads);
+    free(tmp);
 }
 
 // ------------- Approach 1: Segment-based ---------------------
@@ -69,14 +278,12 @@ void merge_sort_p_segment(int* arr, int l, int r) {
         pthread_join(threads[i], NULL);
     }
 
-    // Merge all sorted segments
-    int merged_left = thread_data[0].left;
-    int merged_right = thread_data[0].right;
-
-    for (int i = 1; i < num_threads; i++) {
-        merge(arr, merged_left, merged_right, thread_data[i].right);
-        merged_right = thread_data[i].right;
-    }
+    // Merge all sorted segments at once, split evenly across the threads
+    int bounds[num_threads + 1];
+    for (int i = 0; i < num_threads; i++)
+        bounds[i] = thread_data[i].left;
+    bounds[num_threads] = r + 1;
+    merge_p_kway(arr, bounds, num_threads, num_threads);
 }
 
 // ------------- Approach 2: Recursive-thread-creation -----------
@@ -87,6 +294,7 @@ int max_threads = NUM_THREADS;
 
 typedef struct {
     int* arr;
+    int* buf;   // scratch as long as arr; each call uses only buf[left..right]
     int left;
     int right;
 } recursive_data_t;
@@ -96,7 +304,7 @@ void* recursive_parallel_merge_sort(void* arg) {
     int l = data->left;
     int r = data->right;
 
-    if(l >= r) pthread_exit(NULL);
+    if(l >= r) return NULL;
 
     int m = (l + r) / 2;
 
@@ -114,147 +322,108 @@ void* recursive_parallel_merge_sort(void* arg) {
     }
     pthread_mutex_unlock(&thread_count_mutex);
 
-    recursive_data_t left_data = {data->arr, l, m};
-    recursive_data_t right_data = {data->arr, m + 1, r};
+    recursive_data_t left_data = {data->arr, data->buf, l, m};
+    recursive_data_t right_data = {data->arr, data->buf, m + 1, r};
 
     if(spawn_left) pthread_create(&left_thread, NULL, recursive_parallel_merge_sort, &left_data);
-    else merge_sort_seq(data->arr, l, m);
+    else merge_sort_buf(data->arr + l, m - l + 1, data->buf + l);
 
     if(spawn_right) pthread_create(&right_thread, NULL, recursive_parallel_merge_sort, &right_data);
-    else merge_sort_seq(data->arr, m + 1, r);
+    else merge_sort_buf(data->arr + m + 1, r - m, data->buf + m + 1);
 
     if(spawn_left) pthread_join(left_thread, NULL);
     if(spawn_right) pthread_join(right_thread, NULL);
 
-    merge(data->arr, l, m, r);
+    merge(data->arr, l, m, r, data->buf + l);
 
     pthread_mutex_lock(&thread_count_mutex);
     if(spawn_left) current_thread_count--;
     if(spawn_right) current_thread_count--;
     pthread_mutex_unlock(&thread_count_mutex);
 
-    pthread_exit(NULL);
+    return NULL;
 }
 
+// Sibling subtrees own disjoint slices of one buffer, so no call allocates
 void merge_sort_p_recursive(int* arr, int l, int r) {
-    recursive_data_t data = {arr, l, r};
+    int* buf = (int*)malloc((r + 1) * sizeof(int));
+    recursive_data_t data = {arr, buf, l, r};
     recursive_parallel_merge_sort(&data);
+    free(buf);
 }
 
-// ------------- Approach 3: Thread Pool (Outline) ------------
+// ------------- Approach 3: Work-stealing thread pool ----------
 
-typedef enum { TASK_SORT, TASK_MERGE } task_type_t;
+#define SORT_GRAIN 8192     // subarrays this small are sorted sequentially
+#define MERGE_GRAIN 16384   // output elements per merge-path chunk task
 
-typedef struct task {
-    task_type_t type;
-    int left, mid, right;
+typedef struct {
     int* arr;
-    struct task* next;
-} task_t;
-
-pthread_mutex_t queue_mutex = PTHREAD_MUTEX_INITIALIZER;
-pthread_cond_t queue_cond = PTHREAD_COND_INITIALIZER;
-task_t* task_queue = NULL;
-int tasks_in_progress = 0;
-
-void enqueue_task(task_t* task) {
-    pthread_mutex_lock(&queue_mutex);
-    // add task to queue tail
-    task->next = NULL;
-    if (!task_queue) task_queue = task;
-    else {
-        task_t* last = task_queue;
-        while (last->next) last = last->next;
-        last->next = task;
-    }
-    tasks_in_progress++;
-    pthread_cond_signal(&queue_cond);
-    pthread_mutex_unlock(&queue_mutex);
-}
-
-task_t* dequeue_task() {
-    pthread_mutex_lock(&queue_mutex);
-    while (!task_queue) pthread_cond_wait(&queue_cond, &queue_mutex);
-    task_t* task = task_queue;
-    task_queue = task_queue->next;
-    pthread_mutex_unlock(&queue_mutex);
-    return task;
-}
-
-void* thread_pool_worker(void* arg) {
-    while (1) {
-        task_t* task = NULL;
-        pthread_mutex_lock(&queue_mutex);
-        while (!task_queue) {
-            pthread_cond_wait(&queue_cond, &queue_mutex);
-        }
-        task = task_queue;
-        task_queue = task_queue->next;
-        pthread_mutex_unlock(&queue_mutex);
-
-        if (task == NULL) break;
-
-        if (task->type == TASK_SORT) {
-            merge_sort_seq(task->arr, task->left, task->right);
-        } else if (task->type == TASK_MERGE) {
-            merge(task->arr, task->left, task->mid, task->right);
-        }
+    int* tmp;      // scratch, same indexing as arr
+    int left;
+    int right;
+    int into_tmp;  // leave the sorted range in tmp rather than arr
+} ws_sort_args_t;
 
-        free(task);
+typedef struct {
+    const int* src;
+    int* dst;
+    int left, mid, right;
+    int d0, d1;    // output ranks of this chunk
+} ws_merge_args_t;
 
-        pthread_mutex_lock(&queue_mutex);
-        tasks_in_progress--;
-        if (tasks_in_progress == 0) {
-            pthread_cond_signal(&queue_cond);
-        }
-        pthread_mutex_unlock(&queue_mutex);
-    }
-    pthread_exit(NULL);
+static void ws_merge_chunk(void* arg) {
+    ws_merge_args_t* a = (ws_merge_args_t*)arg;
+    merge_path_chunk(a->src, a->left, a->mid, a->right, a->dst, a->d0, a->d1);
 }
 
-pthread_t thread_pool[NUM_THREADS];
-
-void merge_sort_p_threadpool(int* arr, int l, int r) {
-    // Initialize thread pool
-    for (int i = 0; i < NUM_THREADS; i++) {
-        pthread_create(&thread_pool[i], NULL, thread_pool_worker, NULL);
+// Plain recursive merge sort: fork the left half, sort the right half
+// ourselves, and let idle workers steal whatever is left in our deque.
+// The two buffers swap roles at every level: the halves are sorted into
+// the buffer this call does not finish in, then merged straight into the
+// one it does, so no level copies its output back. Large merges are cut
+// into merge-path chunks so they are shared too.
+static void ws_merge_sort(void* arg) {
+    ws_sort_args_t* a = (ws_sort_args_t*)arg;
+    int l = a->left, r = a->right;
+    int total = r - l + 1;
+
+    if (total <= SORT_GRAIN) {
+        if (total > 1)
+            merge_sort_buf(a->arr + l, total, a->tmp + l);
+        if (a->into_tmp)
+            memcpy(a->tmp + l, a->arr + l, total * sizeof(int));
+        return;
     }
 
-    // For simplicity, divide into NUM_THREADS segments and enqueue sort tasks
-    int segment_size = (r - l + 1) / NUM_THREADS;
-    for (int i = 0; i < NUM_THREADS; i++) {
-        task_t* task = (task_t*)malloc(sizeof(task_t));
-        task->type = TASK_SORT;
-        task->arr = arr;
-        task->left = l + i * segment_size;
-        task->right = (i == NUM_THREADS - 1) ? r : (task->left + segment_size - 1);
-        enqueue_task(task);
+    int m = l + (r - l) / 2;
+    ws_sort_args_t left = {a->arr, a->tmp, l, m, !a->into_tmp};
+    ws_sort_args_t right = {a->arr, a->tmp, m + 1, r, !a->into_tmp};
+    ws_spawn(ws_merge_sort, &left, sizeof(left));
+    ws_merge_sort(&right);
+    ws_sync();
+
+    const int* src = a->into_tmp ? a->arr : a->tmp;
+    int* dst = a->into_tmp ? a->tmp : a->arr;
+    int chunks = (total + MERGE_GRAIN - 1) / MERGE_GRAIN;
+    for (int c = 0; c < chunks; c++) {
+        ws_merge_args_t chunk = {src, dst, l, m, r,
+                                 (int)((long)total * c / chunks),
+                                 (int)((long)total * (c + 1) / chunks)};
+        ws_spawn(ws_merge_chunk, &chunk, sizeof(chunk));
     }
+    ws_sync();
+}
 
-    // Wait until all sorting tasks finished
-    pthread_mutex_lock(&queue_mutex);
-    while (tasks_in_progress > 0) {
-        pthread_cond_wait(&queue_cond, &queue_mutex);
-    }
-    pthread_mutex_unlock(&queue_mutex);
-
-    // Merge segments sequentially for now
-    int merged_left = l;
-    int merged_right = l + segment_size - 1;
-    for (int i = 1; i < NUM_THREADS; i++) {
-        int right_end = (i == NUM_THREADS - 1) ? r : (l + (i + 1)*segment_size - 1);
-        merge(arr, merged_left, merged_right, right_end);
-        merged_right = right_end;
-    }
+void merge_sort_p_threadpool(int* arr, int l, int r) {
+    ws_pool_t* pool = ws_create(NUM_THREADS);
+    int* tmp = (int*)malloc((r + 1) * sizeof(int));
 
-    // Shutdown thread pool by sending NULL tasks
-    for (int i = 0; i < NUM_THREADS; i++) {
-        enqueue_task(NULL);
-    }
+    ws_sort_args_t args = {arr, tmp, l, r, 0};
+    ws_run(pool, ws_merge_sort, &args, sizeof(args));
 
-    for (int i = 0; i < NUM_THREADS; i++) {
-        pthread_join(thread_pool[i], NULL);
-    }
+    free(tmp);
+    ws_destroy(pool);
 }
 
 // ------------- merge_sort_p selects approach --------------------
@@ -3,6 +3,7 @@
 
 #define SIZE 100000
 #define MAX_VAL 100000  // max random number
+#define SORT_BLOCK 64  // merge sort base case, sorted by a sorting network
 
 #include <stdio.h>
 #include <stdlib.h>
@@ -16,10 +17,35 @@ typedef struct {
     int level;
 } thread_data_t;
 
-void merge(int* arr, int l, int m, int r);
+void merge(int* arr, int l, int m, int r, int* L);  // L: m - l + 1 ints of scratch
 void merge_sort_seq(int* arr, int l, int r);
+void merge_sort_buf(int* arr, int n, int* buf);
+void insertion_sort(int* arr, int l, int r);
+void sort_block(int* arr, int n);
+void merge_simd(const int* a, int na, const int* b, int nb, int* dst);
+void merge_branchless(const int* a, int na, const int* b, int nb, int* dst);
+
+int merge_path_split(const int* a, int na, const int* b, int nb, int diag);
+void merge_path_chunk(const int* src, int l, int m, int r, int* dst, int d0, int d1);
+void merge_p(int* arr, int l, int m, int r, int num_threads);
+void merge_p_kway(int* arr, const int* bounds, int k, int num_threads);
 
 void merge_sort_p(int* arr, int l, int r);
+void radix_sort_p(int* arr, int l, int r, int num_threads);
+void sample_sort_p(int* arr, int l, int r, int num_threads);
+void tim_sort(int* arr, int l, int r);
+void tim_sort_p(int* arr, int l, int r, int num_threads);
+void inplace_merge_sort(int* arr, int l, int r);   // O(sqrt(n)) extra memory
+void inplace_merge_sort_p(int* arr, int l, int r, int num_threads);
+
+// Records of elem_size bytes, sorted by an int key (a prefix of the real
+// key when tie_cmp is given to order equal prefixes)
+typedef int (*record_key_fn)(const void* record);
+typedef int (*record_cmp_fn)(const void* a, const void* b);
+void key_index_sort(void* records, int n, size_t elem_size, record_key_fn key,
+                    record_cmp_fn tie_cmp, int num_threads);
+void key_index_sort_perm(const void* records, int n, size_t elem_size, record_key_fn key,
+                         record_cmp_fn tie_cmp, unsigned int* perm, int num_threads);
 void* parallel_merge_sort(void* arg);
 
 void printArray(int* arr, int n);
@@ -0,0 +1,232 @@
+// PARALLEL LSD RADIX SORT (AND A COUNTING SORT FOR SMALL KEY RANGES)
+
+#include "p_merge.h"
+#include <limits.h>
+
+#define RADIX_MAX_BITS 10       // widest digit: 1024 buckets per pass
+#define COUNTING_MAX (1 << 17)  // key ranges up to this use counting sort
+#define WC_SIZE 16              // ints per write-combining buffer (one cache line)
+
+typedef struct {
+    int id;
+    int num_threads;
+    int* arr;
+    int* tmp;
+    int n;
+    unsigned int min;           // smallest key; digits are taken of key - min
+    int bits;                   // digit width
+    int passes;
+    unsigned int range;         // counting sort: max - min
+    long* counts;               // num_threads rows of histogram counts
+    pthread_barrier_t* barrier;
+} radix_data_t;
+
+static void chunk_bounds(int n, int id, int num_threads, int* start, int* end) {
+    *start = (int)((long)n * id / num_threads);
+    *end = (int)((long)n * (id + 1) / num_threads);
+}
+
+// Each thread sorts its chunk's keys into the pass's output: count digits,
+// wait for everyone, turn the counts into this thread's write offsets, then
+// scatter through small per-bucket buffers that are flushed a full cache
+// line at a time instead of touching a random line for every key
+void* radix_worker(void* arg) {
+    radix_data_t* data = (radix_data_t*)arg;
+    int T = data->num_threads;
+    int buckets = 1 << data->bits;
+    unsigned int mask = buckets - 1;
+    long* my_counts = data->counts + (long)data->id * buckets;
+
+    long* offset = (long*)malloc(buckets * sizeof(long));
+    int* fill = (int*)malloc(buckets * sizeof(int));
+    int* wc = (int*)aligned_alloc(64, (size_t)buckets * WC_SIZE * sizeof(int));
+
+    int start, end;
+    chunk_bounds(data->n, data->id, T, &start, &end);
+
+    int* src = data->arr;
+    int* dst = data->tmp;
+    for (int pass = 0; pass < data->passes; pass++) {
+        int shift = pass * data->bits;
+
+        for (int b = 0; b < buckets; b++) my_counts[b] = 0;
+        for (int i = start; i < end; i++)
+            my_counts[(((unsigned int)src[i] - data->min) >> shift) & mask]++;
+        pthread_barrier_wait(data->barrier);
+
+        // offset of bucket b for this thread = all keys in smaller buckets
+        // plus keys of bucket b in lower-numbered threads
+        long base = 0;
+        for (int b = 0; b < buckets; b++) {
+            long before = 0;
+            for (int t = 0; t < T; t++) {
+                long c = data->counts[(long)t * buckets + b];
+                if (t == data->id) before = base;
+                base += c;
+            }
+            offset[b] = before;
+            fill[b] = 0;
+        }
+        // counts may be reset for the next pass only after everyone has read them
+        pthread_barrier_wait(data->barrier);
+
+        for (int i = start; i < end; i++) {
+            int b = (((unsigned int)src[i] - data->min) >> shift) & mask;
+            int* line = wc + (long)b * WC_SIZE;
+            line[fill[b]++] = src[i];
+            if (fill[b] == WC_SIZE) {
+                int* out = dst + offset[b];
+                for (int k = 0; k < WC_SIZE; k++) out[k] = line[k];
+                offset[b] += WC_SIZE;
+                fill[b] = 0;
+            }
+        }
+        for (int b = 0; b < buckets; b++) {
+            int* out = dst + offset[b];
+            for (int k = 0; k < fill[b]; k++) out[k] = wc[(long)b * WC_SIZE + k];
+        }
+        pthread_barrier_wait(data->barrier);
+
+        int* t = src; src = dst; dst = t;
+    }
+
+    // An odd number of passes leaves the keys in tmp
+    if (src != data->arr)
+        for (int i = start; i < end; i++) data->arr[i] = src[i];
+
+    free(offset);
+    free(fill);
+    free(wc);
+    return NULL;
+}
+
+// Counting sort: histogram per thread, then every thread rewrites an equal
+// slice of the output, finding the key it starts at by binary search
+void* counting_worker(void* arg) {
+    radix_data_t* data = (radix_data_t*)arg;
+    int T = data->num_threads;
+    long values = (long)data->range + 1;
+    long* my_counts = data->counts + (long)data->id * values;
+
+    int start, end;
+    chunk_bounds(data->n, data->id, T, &start, &end);
+
+    for (long v = 0; v < values; v++) my_counts[v] = 0;
+    for (int i = start; i < end; i++)
+        my_counts[(unsigned int)data->arr[i] - data->min]++;
+    pthread_barrier_wait(data->barrier);
+
+    // Thread t folds column slice t of the histograms into row 0 as
+    // running totals of its slice; row 0 then holds per-slice prefix sums
+    long v0 = values * data->id / T, v1 = values * (data->id + 1) / T;
+    long sum = 0;
+    for (long v = v0; v < v1; v++) {
+        for (int t = 0; t < T; t++) sum += data->counts[(long)t * values + v];
+        data->counts[v] = sum;
+    }
+    pthread_barrier_wait(data->barrier);
+
+    // Add the totals of earlier slices so row 0 is the inclusive prefix sum
+    long carry = 0;
+    for (int t = 0; t < data->id; t++) {
+        long e = values * (t + 1) / T;
+        if (e > values * t / T) carry += data->counts[e - 1];
+    }
+    pthread_barrier_wait(data->barrier);
+    for (long v = v0; v < v1; v++) data->counts[v] += carry;
+    pthread_barrier_wait(data->barrier);
+
+    // First value whose inclusive prefix passes our first output slot
+    long lo = 0, hi = values - 1;
+    while (lo < hi) {
+        long mid = lo + (hi - lo) / 2;
+        if (data->counts[mid] > start) hi = mid; else lo = mid + 1;
+    }
+    for (int i = start; i < end; i++) {
+        while (data->counts[lo] <= i) lo++;
+        data->arr[i] = (int)(data->min + (unsigned int)lo);
+    }
+    return NULL;
+}
+
+typedef struct {
+    int* arr;
+    int start, end;
+    int min, max;
+} minmax_data_t;
+
+void* minmax_worker(void* arg) {
+    minmax_data_t* data = (minmax_data_t*)arg;
+    int lo = INT_MAX, hi = INT_MIN;
+    for (int i = data->start; i < data->end; i++) {
+        if (data->arr[i] < lo) lo = data->arr[i];
+        if (data->arr[i] > hi) hi = data->arr[i];
+    }
+    data->min = lo;
+    data->max = hi;
+    return NULL;
+}
+
+// Sort arr[l..r]. The key range picks the method: counting sort when it
+// is at most COUNTING_MAX wide, otherwise LSD radix with the fewest passes
+// of at most RADIX_MAX_BITS bits, spread evenly over the range's bits.
+void radix_sort_p(int* arr, int l, int r, int num_threads) {
+    int n = r - l + 1;
+    if (n < 2) return;
+    arr += l;
+    if (num_threads > n) num_threads = n;
+
+    pthread_t threads[num_threads];
+    minmax_data_t mm[num_threads];
+    for (int t = 0; t < num_threads; t++) {
+        mm[t].arr = arr;
+        chunk_bounds(n, t, num_threads, &mm[t].start, &mm[t].end);
+        pthread_create(&threads[t], NULL, minmax_worker, &mm[t]);
+    }
+    int min = INT_MAX, max = INT_MIN;
+    for (int t = 0; t < num_threads; t++) {
+        pthread_join(threads[t], NULL);
+        if (mm[t].min < min) min = mm[t].min;
+        if (mm[t].max > max) max = mm[t].max;
+    }
+
+    unsigned int range = (unsigned int)max - (unsigned int)min;
+    if (range == 0) return;
+
+    radix_data_t proto = {0};
+    proto.num_threads = num_threads;
+    proto.arr = arr;
+    proto.n = n;
+    proto.min = (unsigned int)min;
+    proto.range = range;
+
+    int counting = range < COUNTING_MAX;
+    long row;
+    if (counting) {
+        row = (long)range + 1;
+    } else {
+        int key_bits = 32 - __builtin_clz(range);
+        proto.passes = (key_bits + RADIX_MAX_BITS - 1) / RADIX_MAX_BITS;
+        proto.bits = (key_bits + proto.passes - 1) / proto.passes;
+        proto.tmp = (int*)malloc((long)n * sizeof(int));
+        row = 1L << proto.bits;
+    }
+    proto.counts = (long*)malloc(num_threads * row * sizeof(long));
+
+    pthread_barrier_t barrier;
+    pthread_barrier_init(&barrier, NULL, num_threads);
+    proto.barrier = &barrier;
+
+    radix_data_t data[num_threads];
+    for (int t = 0; t < num_threads; t++) {
+        data[t] = proto;
+        data[t].id = t;
+        pthread_create(&threads[t], NULL, counting ? counting_worker : radix_worker, &data[t]);
+    }
+    for (int t = 0; t < num_threads; t++)
+        pthread_join(threads[t], NULL);
+
+    pthread_barrier_destroy(&barrier);
+    free(proto.counts);
+    free(proto.tmp);
+}
@@ -0,0 +1,145 @@
+// PARALLEL SAMPLE SORT
+
+#include "p_merge.h"
+#include <stdatomic.h>
+
+#define OVERSAMPLE 64          // samples drawn per bucket
+#define BUCKETS_PER_THREAD 4   // extra buckets even out the sorting phase
+#define SAMPLE_MIN_SIZE 65536  // below this just sort sequentially
+
+typedef struct {
+    int id;
+    int num_threads;
+    int* arr;
+    int* tmp;
+    unsigned short* bucket_of;  // bucket chosen for each element
+    int n;
+    int num_buckets;
+    const int* splitters;       // num_buckets - 1, sorted
+    const int* run_end;         // last index of each splitter's run of equal values
+    long* counts;               // num_threads rows of num_buckets
+    long* bucket_start;         // num_buckets + 1
+    atomic_int* next_bucket;
+    pthread_barrier_t* barrier;
+} sample_data_t;
+
+// First splitter >= x. A key equal to a run of duplicated splitters
+// s[b..e] may go to any bucket b..e+1 (all of them border on that value),
+// so such keys are spread over the run by position. Buckets strictly
+// inside the run then hold only that value, and one hot key can't pile
+// up in a single bucket.
+static int classify(const sample_data_t* data, int x, int i) {
+    int lo = 0, hi = data->num_buckets - 1;
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (data->splitters[mid] < x) lo = mid + 1; else hi = mid;
+    }
+    if (lo < data->num_buckets - 1 && data->splitters[lo] == x) {
+        int width = data->run_end[lo] - lo + 2;
+        if (width > 2) return lo + i % width;
+    }
+    return lo;
+}
+
+void* sample_worker(void* arg) {
+    sample_data_t* data = (sample_data_t*)arg;
+    int T = data->num_threads;
+    int B = data->num_buckets;
+    long* my_counts = data->counts + (long)data->id * B;
+    int start = (int)((long)data->n * data->id / T);
+    int end = (int)((long)data->n * (data->id + 1) / T);
+
+    // 1. classify our chunk
+    for (int b = 0; b < B; b++) my_counts[b] = 0;
+    for (int i = start; i < end; i++) {
+        int b = classify(data, data->arr[i], i);
+        data->bucket_of[i] = (unsigned short)b;
+        my_counts[b]++;
+    }
+    pthread_barrier_wait(data->barrier);
+
+    // 2. our write position in each bucket, then scatter into tmp
+    long* offset = (long*)malloc(B * sizeof(long));
+    long base = 0;
+    for (int b = 0; b < B; b++) {
+        if (data->id == 0) data->bucket_start[b] = base;
+        for (int t = 0; t < T; t++) {
+            if (t == data->id) offset[b] = base;
+            base += data->counts[(long)t * B + b];
+        }
+    }
+    if (data->id == 0) data->bucket_start[B] = base;
+
+    for (int i = start; i < end; i++)
+        data->tmp[offset[data->bucket_of[i]]++] = data->arr[i];
+    free(offset);
+    pthread_barrier_wait(data->barrier);
+
+    // 3. claim whole buckets and sort them; arr is free to use as scratch
+    int b;
+    while ((b = atomic_fetch_add(data->next_bucket, 1)) < B) {
+        long lo = data->bucket_start[b];
+        int len = (int)(data->bucket_start[b + 1] - lo);
+        int all_equal = b > 0 && b < B - 1 && data->splitters[b - 1] == data->splitters[b];
+        if (!all_equal && len > 1)
+            merge_sort_buf(data->tmp + lo, len, data->arr + lo);
+        for (long i = lo; i < lo + len; i++)
+            data->arr[i] = data->tmp[i];
+    }
+    return NULL;
+}
+
+// Sort arr[l..r]: pick splitters from a sorted random sample, move every
+// element to its bucket in one parallel pass, then sort the buckets
+// independently. Bucket order is final order, so there is no merge at all.
+void sample_sort_p(int* arr, int l, int r, int num_threads) {
+    int n = r - l + 1;
+    if (n < SAMPLE_MIN_SIZE || num_threads < 2) {
+        merge_sort_seq(arr, l, r);
+        return;
+    }
+    arr += l;
+
+    int B = num_threads * BUCKETS_PER_THREAD;
+    int num_samples = B * OVERSAMPLE;
+    int* samples = (int*)malloc(num_samples * sizeof(int));
+    unsigned int seed = (unsigned int)time(NULL);
+    for (int s = 0; s < num_samples; s++)
+        samples[s] = arr[(int)(((unsigned long)rand_r(&seed) * RAND_MAX + rand_r(&seed)) % n)];
+    merge_sort_seq(samples, 0, num_samples - 1);
+
+    int* splitters = (int*)malloc((B - 1) * sizeof(int));
+    int* run_end = (int*)malloc((B - 1) * sizeof(int));
+    for (int b = 0; b < B - 1; b++)
+        splitters[b] = samples[(b + 1) * OVERSAMPLE];
+    for (int b = B - 2; b >= 0; b--)
+        run_end[b] = (b + 1 < B - 1 && splitters[b + 1] == splitters[b]) ? run_end[b + 1] : b;
+    free(samples);
+
+    int* tmp = (int*)malloc((long)n * sizeof(int));
+    unsigned short* bucket_of = (unsigned short*)malloc((long)n * sizeof(unsigned short));
+    long* counts = (long*)malloc((long)num_threads * B * sizeof(long));
+    long* bucket_start = (long*)malloc((B + 1) * sizeof(long));
+    atomic_int next_bucket = 0;
+    pthread_barrier_t barrier;
+    pthread_barrier_init(&barrier, NULL, num_threads);
+
+    pthread_t threads[num_threads];
+    sample_data_t data[num_threads];
+    for (int t = 0; t < num_threads; t++) {
+        data[t] = (sample_data_t){t, num_threads, arr, tmp, bucket_of, n, B,
+                                  splitters, run_end, counts, bucket_start,
+                                  &next_bucket, &barrier};
+        pthread_create(&threads[t], NULL, sample_worker, &data[t]);
+    }
+    for (int t = 0; t < num_threads; t++)
+        pthread_join(threads[t], NULL);
+
+    pthread_barrier_destroy(&barrier);
+    free(splitters);
+    free(run_end);
+    free(tmp);
+    free(bucket_of);
+    free(counts);
+    free(bucket_start);
+}
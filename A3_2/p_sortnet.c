@@ -0,0 +1,181 @@
+// SORTING-NETWORK BASE CASE AND MERGE KERNELS FOR THE MERGE SORTS
+//
+// Compiled with -mavx2 (or -march=native) the blocks at the bottom of the
+// merge sort are sorted by a bitonic network in eight AVX2 registers and
+// runs are merged eight elements at a time; neither has a data-dependent
+// branch per element. Without AVX2 the same functions fall back to
+// insertion sort and a branchless scalar merge.
+
+#include "p_merge.h"
+#include <limits.h>
+
+#ifdef __AVX2__
+#include <immintrin.h>
+
+// Sort each 8-lane vector given that it is bitonic: compare-exchange at
+// lane distance 4, 2, then 1
+static inline __m256i bitonic_clean8(__m256i v) {
+    __m256i p = _mm256_permute2x128_si256(v, v, 0x01);
+    v = _mm256_blend_epi32(_mm256_min_epi32(v, p), _mm256_max_epi32(v, p), 0xF0);
+    p = _mm256_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2));
+    v = _mm256_blend_epi32(_mm256_min_epi32(v, p), _mm256_max_epi32(v, p), 0xCC);
+    p = _mm256_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1));
+    v = _mm256_blend_epi32(_mm256_min_epi32(v, p), _mm256_max_epi32(v, p), 0xAA);
+    return v;
+}
+
+static inline __m256i reverse8(__m256i v) {
+    return _mm256_permutevar8x32_epi32(v, _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0));
+}
+
+static inline void cmpx(__m256i* a, __m256i* b) {
+    __m256i lo = _mm256_min_epi32(*a, *b);
+    *b = _mm256_max_epi32(*a, *b);
+    *a = lo;
+}
+
+// Two sorted vectors in, the 8 smallest in *a and the 8 largest in *b
+static inline void merge8x2(__m256i* a, __m256i* b) {
+    *b = reverse8(*b);
+    cmpx(a, b);
+    *a = bitonic_clean8(*a);
+    *b = bitonic_clean8(*b);
+}
+
+// Merge neighbouring sorted runs of `run` vectors in v[0..7] pairwise
+static inline void merge_runs8(__m256i* v, int run) {
+    for (int s = 0; s < 8; s += 2 * run) {
+        // reversing the second run makes the pair one bitonic sequence
+        for (int i = 0; i < run / 2; i++) {
+            __m256i t = v[s + run + i];
+            v[s + run + i] = reverse8(v[s + 2 * run - 1 - i]);
+            v[s + 2 * run - 1 - i] = reverse8(t);
+        }
+        if (run == 1) v[s + 1] = reverse8(v[s + 1]);
+
+        for (int d = run; d >= 1; d /= 2)
+            for (int b = s; b < s + 2 * run; b += 2 * d)
+                for (int i = b; i < b + d; i++)
+                    cmpx(&v[i], &v[i + d]);
+
+        for (int i = s; i < s + 2 * run; i++)
+            v[i] = bitonic_clean8(v[i]);
+    }
+}
+
+static inline void transpose8(__m256i* v) {
+    __m256i t0 = _mm256_unpacklo_epi32(v[0], v[1]), t1 = _mm256_unpackhi_epi32(v[0], v[1]);
+    __m256i t2 = _mm256_unpacklo_epi32(v[2], v[3]), t3 = _mm256_unpackhi_epi32(v[2], v[3]);
+    __m256i t4 = _mm256_unpacklo_epi32(v[4], v[5]), t5 = _mm256_unpackhi_epi32(v[4], v[5]);
+    __m256i t6 = _mm256_unpacklo_epi32(v[6], v[7]), t7 = _mm256_unpackhi_epi32(v[6], v[7]);
+    __m256i u0 = _mm256_unpacklo_epi64(t0, t2), u1 = _mm256_unpackhi_epi64(t0, t2);
+    __m256i u2 = _mm256_unpacklo_epi64(t1, t3), u3 = _mm256_unpackhi_epi64(t1, t3);
+    __m256i u4 = _mm256_unpacklo_epi64(t4, t6), u5 = _mm256_unpackhi_epi64(t4, t6);
+    __m256i u6 = _mm256_unpacklo_epi64(t5, t7), u7 = _mm256_unpackhi_epi64(t5, t7);
+    v[0] = _mm256_permute2x128_si256(u0, u4, 0x20);
+    v[1] = _mm256_permute2x128_si256(u1, u5, 0x20);
+    v[2] = _mm256_permute2x128_si256(u2, u6, 0x20);
+    v[3] = _mm256_permute2x128_si256(u3, u7, 0x20);
+    v[4] = _mm256_permute2x128_si256(u0, u4, 0x31);
+    v[5] = _mm256_permute2x128_si256(u1, u5, 0x31);
+    v[6] = _mm256_permute2x128_si256(u2, u6, 0x31);
+    v[7] = _mm256_permute2x128_si256(u3, u7, 0x31);
+}
+
+// Sort n <= SORT_BLOCK ints. Short blocks are padded with INT_MAX, which
+// sorts to the end and is never copied back.
+void sort_block(int* arr, int n) {
+    if (n < 16) {
+        insertion_sort(arr, 0, n - 1);
+        return;
+    }
+
+    __attribute__((aligned(32))) int buf[SORT_BLOCK];
+    const int* src = arr;
+    if (n < SORT_BLOCK) {
+        for (int i = 0; i < n; i++) buf[i] = arr[i];
+        for (int i = n; i < SORT_BLOCK; i++) buf[i] = INT_MAX;
+        src = buf;
+    }
+
+    __m256i v[8];
+    for (int i = 0; i < 8; i++)
+        v[i] = _mm256_loadu_si256((const __m256i*)(src + 8 * i));
+
+    // Optimal 19-comparator network on the eight registers sorts every
+    // column; transposing turns the columns into eight sorted rows
+    cmpx(&v[0], &v[2]); cmpx(&v[1], &v[3]); cmpx(&v[4], &v[6]); cmpx(&v[5], &v[7]);
+    cmpx(&v[0], &v[4]); cmpx(&v[1], &v[5]); cmpx(&v[2], &v[6]); cmpx(&v[3], &v[7]);
+    cmpx(&v[0], &v[1]); cmpx(&v[2], &v[3]); cmpx(&v[4], &v[5]); cmpx(&v[6], &v[7]);
+    cmpx(&v[2], &v[4]); cmpx(&v[3], &v[5]);
+    cmpx(&v[1], &v[4]); cmpx(&v[3], &v[6]);
+    cmpx(&v[1], &v[2]); cmpx(&v[3], &v[4]); cmpx(&v[5], &v[6]);
+    transpose8(v);
+
+    // 8 runs of 8 -> 4 of 16 -> 2 of 32 -> 1 of 64
+    merge_runs8(v, 1);
+    merge_runs8(v, 2);
+    merge_runs8(v, 4);
+
+    if (n == SORT_BLOCK) {
+        for (int i = 0; i < 8; i++)
+            _mm256_storeu_si256((__m256i*)(arr + 8 * i), v[i]);
+    } else {
+        for (int i = 0; i < 8; i++)
+            _mm256_store_si256((__m256i*)(buf + 8 * i), v[i]);
+        for (int i = 0; i < n; i++) arr[i] = buf[i];
+    }
+}
+
+// Merge sorted a[0..na) and b[0..nb) into dst, 8 at a time: the vector
+// holding the 8 largest so far is merged with the next block from
+// whichever input has the smaller head. na and nb must be multiples of 8.
+void merge_simd(const int* a, int na, const int* b, int nb, int* dst) {
+    __m256i lo = _mm256_loadu_si256((const __m256i*)a);
+    __m256i hi = _mm256_loadu_si256((const __m256i*)b);
+    int i = 8, j = 8;
+    merge8x2(&lo, &hi);
+    _mm256_storeu_si256((__m256i*)dst, lo);
+    dst += 8;
+
+    while (i < na || j < nb) {
+        if (j >= nb || (i < na && a[i] <= b[j])) {
+            lo = _mm256_loadu_si256((const __m256i*)(a + i));
+            i += 8;
+        } else {
+            lo = _mm256_loadu_si256((const __m256i*)(b + j));
+            j += 8;
+        }
+        merge8x2(&lo, &hi);
+        _mm256_storeu_si256((__m256i*)dst, lo);
+        dst += 8;
+    }
+    _mm256_storeu_si256((__m256i*)dst, hi);
+}
+
+#else
+
+void sort_block(int* arr, int n) {
+    insertion_sort(arr, 0, n - 1);
+}
+
+void merge_simd(const int* a, int na, const int* b, int nb, int* dst) {
+    merge_branchless(a, na, b, nb, dst);
+}
+
+#endif
+
+// Which input advances is computed, not branched on, so the compiler
+// emits conditional moves and random data costs no mispredictions
+void merge_branchless(const int* a, int na, const int* b, int nb, int* dst) {
+    int i = 0, j = 0, k = 0;
+    while (i < na && j < nb) {
+        int x = a[i], y = b[j];
+        int take_b = y < x;
+        dst[k++] = take_b ? y : x;
+        i += !take_b;
+        j += take_b;
+    }
+    while (i < na) dst[k++] = a[i++];
+    while (j < nb) dst[k++] = b[j++];
+}
@@ -0,0 +1,458 @@
+// ADAPTIVE NATURAL MERGE SORT (TIMSORT)
+//
+// Follows the structure of CPython's listsort / Java's TimSort: find the
+// natural ascending or strictly descending runs (descending ones are
+// reversed), extend short runs to min_run, and keep a stack of pending
+// runs whose lengths grow at least like Fibonacci, so merges stay
+// balanced. Merges gallop when one side keeps winning, so already ordered
+// stretches are copied in bulk. Sorted or reversed input is one run and
+// costs a single O(n) scan.
+//
+// Short runs are extended by sorting a whole min_run block with
+// sort_block, and two runs built only that way are merged with the
+// SIMD/branchless kernels: galloping only pays when the data has structure.
+
+#include "p_merge.h"
+#include <string.h>
+
+#define MIN_MERGE SORT_BLOCK  // shorter arrays are just binary-insertion sorted
+#define MIN_GALLOP 7          // wins in a row before a merge starts galloping
+#define MAX_RUNS 85           // enough pending runs for any int length
+
+typedef struct {
+    int* a;
+    int* tmp;
+    int tmp_len;
+    int min_gallop;
+    int stack_size;
+    int run_base[MAX_RUNS];
+    int run_len[MAX_RUNS];
+    char run_natural[MAX_RUNS];  // 0: built only from short runs
+} tim_state_t;
+
+static int min_run_length(int n) {
+    int r = 0;
+    while (n >= MIN_MERGE) {
+        r |= n & 1;
+        n >>= 1;
+    }
+    return n + r;
+}
+
+// Length of the run starting at lo (hi exclusive); a descending run is
+// reversed in place. Descending must be strict to keep the sort stable.
+static int count_run(int* a, int lo, int hi) {
+    int run_hi = lo + 1;
+    if (run_hi == hi) return 1;
+
+    if (a[run_hi++] < a[lo]) {
+        while (run_hi < hi && a[run_hi] < a[run_hi - 1]) run_hi++;
+        for (int i = lo, j = run_hi - 1; i < j; i++, j--) {
+            int t = a[i]; a[i] = a[j]; a[j] = t;
+        }
+    } else {
+        while (run_hi < hi && a[run_hi] >= a[run_hi - 1]) run_hi++;
+    }
+    return run_hi - lo;
+}
+
+// a[lo..start) is sorted; insert a[start..hi) one by one
+static void binary_insertion_sort(int* a, int lo, int hi, int start) {
+    if (start == lo) start++;
+    for (; start < hi; start++) {
+        int pivot = a[start];
+        int left = lo, right = start;
+        while (left < right) {
+            int mid = (left + right) >> 1;
+            if (pivot < a[mid]) right = mid;
+            else left = mid + 1;
+        }
+        memmove(&a[left + 1], &a[left], (start - left) * sizeof(int));
+        a[left] = pivot;
+    }
+}
+
+// Leftmost position for key in sorted a[base..base+len), searching
+// outwards from hint with doubling steps before the binary search
+static int gallop_left(int key, const int* a, int base, int len, int hint) {
+    int last_ofs = 0, ofs = 1;
+    if (key > a[base + hint]) {
+        int max_ofs = len - hint;
+        while (ofs < max_ofs && key > a[base + hint + ofs]) {
+            last_ofs = ofs;
+            ofs = (ofs << 1) + 1;
+            if (ofs <= 0) ofs = max_ofs;
+        }
+        if (ofs > max_ofs) ofs = max_ofs;
+        last_ofs += hint;
+        ofs += hint;
+    } else {
+        int max_ofs = hint + 1;
+        while (ofs < max_ofs && key <= a[base + hint - ofs]) {
+            last_ofs = ofs;
+            ofs = (ofs << 1) + 1;
+            if (ofs <= 0) ofs = max_ofs;
+        }
+        if (ofs > max_ofs) ofs = max_ofs;
+        int t = last_ofs;
+        last_ofs = hint - ofs;
+        ofs = hint - t;
+    }
+
+    last_ofs++;
+    while (last_ofs < ofs) {
+        int m = last_ofs + ((ofs - last_ofs) >> 1);
+        if (key > a[base + m]) last_ofs = m + 1;
+        else ofs = m;
+    }
+    return ofs;
+}
+
+// Rightmost position for key (after any equal elements)
+static int gallop_right(int key, const int* a, int base, int len, int hint) {
+    int last_ofs = 0, ofs = 1;
+    if (key < a[base + hint]) {
+        int max_ofs = hint + 1;
+        while (ofs < max_ofs && key < a[base + hint - ofs]) {
+            last_ofs = ofs;
+            ofs = (ofs << 1) + 1;
+            if (ofs <= 0) ofs = max_ofs;
+        }
+        if (ofs > max_ofs) ofs = max_ofs;
+        int t = last_ofs;
+        last_ofs = hint - ofs;
+        ofs = hint - t;
+    } else {
+        int max_ofs = len - hint;
+        while (ofs < max_ofs && key >= a[base + hint + ofs]) {
+            last_ofs = ofs;
+            ofs = (ofs << 1) + 1;
+            if (ofs <= 0) ofs = max_ofs;
+        }
+        if (ofs > max_ofs) ofs = max_ofs;
+        last_ofs += hint;
+        ofs += hint;
+    }
+
+    last_ofs++;
+    while (last_ofs < ofs) {
+        int m = last_ofs + ((ofs - last_ofs) >> 1);
+        if (key < a[base + m]) ofs = m;
+        else last_ofs = m + 1;
+    }
+    return ofs;
+}
+
+static int* ensure_tmp(tim_state_t* s, int len) {
+    if (s->tmp_len < len) {
+        free(s->tmp);
+        s->tmp_len = len;
+        s->tmp = (int*)malloc(len * sizeof(int));
+    }
+    return s->tmp;
+}
+
+// Merge adjacent runs with len1 <= len2, copying the first one out
+static void merge_lo(tim_state_t* s, int base1, int len1, int base2, int len2) {
+    int* a = s->a;
+    int* tmp = ensure_tmp(s, len1);
+    memcpy(tmp, a + base1, len1 * sizeof(int));
+
+    int c1 = 0, c2 = base2, dest = base1;
+    a[dest++] = a[c2++];  // a[base2] < a[base1] after the trim in merge_at
+    if (--len2 == 0) {
+        memcpy(a + dest, tmp + c1, len1 * sizeof(int));
+        return;
+    }
+    if (len1 == 1) {
+        memmove(a + dest, a + c2, len2 * sizeof(int));
+        a[dest + len2] = tmp[c1];
+        return;
+    }
+
+    int min_gallop = s->min_gallop;
+    while (1) {
+        int count1 = 0, count2 = 0;
+
+        // one element at a time until one side wins min_gallop in a row
+        do {
+            if (a[c2] < tmp[c1]) {
+                a[dest++] = a[c2++];
+                count2++;
+                count1 = 0;
+                if (--len2 == 0) goto done;
+            } else {
+                a[dest++] = tmp[c1++];
+                count1++;
+                count2 = 0;
+                if (--len1 == 1) goto done;
+            }
+        } while ((count1 | count2) < min_gallop);
+
+        // then gallop, copying whole stretches, while that keeps paying off
+        do {
+            count1 = gallop_right(a[c2], tmp, c1, len1, 0);
+            if (count1 != 0) {
+                memcpy(a + dest, tmp + c1, count1 * sizeof(int));
+                dest += count1;
+                c1 += count1;
+                len1 -= count1;
+                if (len1 <= 1) goto done;
+            }
+            a[dest++] = a[c2++];
+            if (--len2 == 0) goto done;
+
+            count2 = gallop_left(tmp[c1], a, c2, len2, 0);
+            if (count2 != 0) {
+                memmove(a + dest, a + c2, count2 * sizeof(int));
+                dest += count2;
+                c2 += count2;
+                len2 -= count2;
+                if (len2 == 0) goto done;
+            }
+            a[dest++] = tmp[c1++];
+            if (--len1 == 1) goto done;
+            min_gallop--;
+        } while (count1 >= MIN_GALLOP || count2 >= MIN_GALLOP);
+        if (min_gallop < 0) min_gallop = 0;
+        min_gallop += 2;  // penalty for leaving gallop mode
+    }
+
+done:
+    s->min_gallop = min_gallop < 1 ? 1 : min_gallop;
+    if (len1 == 1) {
+        memmove(a + dest, a + c2, len2 * sizeof(int));
+        a[dest + len2] = tmp[c1];
+    } else {
+        memcpy(a + dest, tmp + c1, len1 * sizeof(int));
+    }
+}
+
+// Mirror image of merge_lo for len1 > len2: copy the second run out and
+// merge from the right
+static void merge_hi(tim_state_t* s, int base1, int len1, int base2, int len2) {
+    int* a = s->a;
+    int* tmp = ensure_tmp(s, len2);
+    memcpy(tmp, a + base2, len2 * sizeof(int));
+
+    int c1 = base1 + len1 - 1, c2 = len2 - 1, dest = base2 + len2 - 1;
+    a[dest--] = a[c1--];
+    if (--len1 == 0) {
+        memcpy(a + dest - (len2 - 1), tmp, len2 * sizeof(int));
+        return;
+    }
+    if (len2 == 1) {
+        dest -= len1;
+        c1 -= len1;
+        memmove(a + dest + 1, a + c1 + 1, len1 * sizeof(int));
+        a[dest] = tmp[c2];
+        return;
+    }
+
+    int min_gallop = s->min_gallop;
+    while (1) {
+        int count1 = 0, count2 = 0;
+
+        do {
+            if (tmp[c2] < a[c1]) {
+                a[dest--] = a[c1--];
+                count1++;
+                count2 = 0;
+                if (--len1 == 0) goto done;
+            } else {
+                a[dest--] = tmp[c2--];
+                count2++;
+                count1 = 0;
+                if (--len2 == 1) goto done;
+            }
+        } while ((count1 | count2) < min_gallop);
+
+        do {
+            count1 = len1 - gallop_right(tmp[c2], a, base1, len1, len1 - 1);
+            if (count1 != 0) {
+                dest -= count1;
+                c1 -= count1;
+                len1 -= count1;
+                memmove(a + dest + 1, a + c1 + 1, count1 * sizeof(int));
+                if (len1 == 0) goto done;
+            }
+            a[dest--] = tmp[c2--];
+            if (--len2 == 1) goto done;
+
+            count2 = len2 - gallop_left(a[c1], tmp, 0, len2, len2 - 1);
+            if (count2 != 0) {
+                dest -= count2;
+                c2 -= count2;
+                len2 -= count2;
+                memcpy(a + dest + 1, tmp + c2 + 1, count2 * sizeof(int));
+                if (len2 <= 1) goto done;
+            }
+            a[dest--] = a[c1--];
+            if (--len1 == 0) goto done;
+            min_gallop--;
+        } while (count1 >= MIN_GALLOP || count2 >= MIN_GALLOP);
+        if (min_gallop < 0) min_gallop = 0;
+        min_gallop += 2;
+    }
+
+done:
+    s->min_gallop = min_gallop < 1 ? 1 : min_gallop;
+    if (len2 == 1) {
+        dest -= len1;
+        c1 -= len1;
+        memmove(a + dest + 1, a + c1 + 1, len1 * sizeof(int));
+        a[dest] = tmp[c2];
+    } else {
+        memcpy(a + dest - (len2 - 1), tmp, len2 * sizeof(int));
+    }
+}
+
+// Merge stack runs i and i+1
+static void merge_at(tim_state_t* s, int i) {
+    int base1 = s->run_base[i], len1 = s->run_len[i];
+    int base2 = s->run_base[i + 1], len2 = s->run_len[i + 1];
+    int natural = s->run_natural[i] | s->run_natural[i + 1];
+
+    s->run_len[i] = len1 + len2;
+    s->run_natural[i] = natural;
+    if (i == s->stack_size - 3) {
+        s->run_base[i + 1] = s->run_base[i + 2];
+        s->run_len[i + 1] = s->run_len[i + 2];
+        s->run_natural[i + 1] = s->run_natural[i + 2];
+    }
+    s->stack_size--;
+
+    if (!natural) {
+        // random data: no gallops, no data-dependent branches
+        if (s->a[base1 + len1 - 1] <= s->a[base2]) return;
+        int* tmp = ensure_tmp(s, len1);
+        memcpy(tmp, s->a + base1, len1 * sizeof(int));
+        if (len1 % 8 == 0 && len2 % 8 == 0)
+            merge_simd(tmp, len1, s->a + base2, len2, s->a + base1);
+        else
+            merge_branchless(tmp, len1, s->a + base2, len2, s->a + base1);
+        return;
+    }
+
+    // Elements of run 1 already below run 2's first, and of run 2 already
+    // above run 1's last, are in place; merge only what is left
+    int k = gallop_right(s->a[base2], s->a, base1, len1, 0);
+    base1 += k;
+    len1 -= k;
+    if (len1 == 0) return;
+    len2 = gallop_left(s->a[base1 + len1 - 1], s->a, base2, len2, len2 - 1);
+    if (len2 == 0) return;
+
+    if (len1 <= len2) merge_lo(s, base1, len1, base2, len2);
+    else merge_hi(s, base1, len1, base2, len2);
+}
+
+// Restore the invariants len[i-2] > len[i-1] + len[i] and len[i-1] > len[i]
+// on the run stack (checking one level deeper than the original TimSort,
+// which could let them break)
+static void merge_collapse(tim_state_t* s) {
+    while (s->stack_size > 1) {
+        int n = s->stack_size - 2;
+        int* len = s->run_len;
+        if ((n > 0 && len[n - 1] <= len[n] + len[n + 1]) ||
+            (n > 1 && len[n - 2] <= len[n] + len[n - 1])) {
+            if (len[n - 1] < len[n + 1]) n--;
+        } else if (len[n] > len[n + 1]) {
+            break;
+        }
+        merge_at(s, n);
+    }
+}
+
+static void merge_force_collapse(tim_state_t* s) {
+    while (s->stack_size > 1) {
+        int n = s->stack_size - 2;
+        if (n > 0 && s->run_len[n - 1] < s->run_len[n + 1]) n--;
+        merge_at(s, n);
+    }
+}
+
+void tim_sort(int* arr, int l, int r) {
+    int* a = arr + l;
+    int n = r - l + 1;
+    if (n < 2) return;
+
+    if (n < MIN_MERGE) {
+        binary_insertion_sort(a, 0, n, count_run(a, 0, n));
+        return;
+    }
+
+    tim_state_t s;
+    s.a = a;
+    s.tmp = NULL;
+    s.tmp_len = 0;
+    s.min_gallop = MIN_GALLOP;
+    s.stack_size = 0;
+
+    int min_run = (min_run_length(n) + 7) & ~7;  // keeps forced runs SIMD-mergeable
+    int lo = 0;
+    while (lo < n) {
+        int run_len = count_run(a, lo, n);
+        int natural = run_len >= min_run;
+        if (!natural) {
+            int force = (n - lo < min_run) ? n - lo : min_run;
+            sort_block(a + lo, force);
+            run_len = force;
+        }
+
+        s.run_base[s.stack_size] = lo;
+        s.run_len[s.stack_size] = run_len;
+        s.run_natural[s.stack_size] = natural;
+        s.stack_size++;
+        merge_collapse(&s);
+
+        lo += run_len;
+    }
+    merge_force_collapse(&s);
+    free(s.tmp);
+}
+
+// ------------- Parallel version -------------------------------------
+
+typedef struct {
+    int* arr;
+    int left;
+    int right;
+} tim_data_t;
+
+void* tim_sort_worker(void* arg) {
+    tim_data_t* data = (tim_data_t*)arg;
+    tim_sort(data->arr, data->left, data->right);
+    return NULL;
+}
+
+// Each thread TimSorts one chunk, then the chunks are merged in one
+// parallel merge-path pass. If the chunks already line up (presorted
+// input) the merge is skipped, so the whole sort stays O(n).
+void tim_sort_p(int* arr, int l, int r, int num_threads) {
+    int n = r - l + 1;
+    if (num_threads < 2 || n < num_threads * MIN_MERGE * 64) {
+        tim_sort(arr, l, r);
+        return;
+    }
+
+    pthread_t threads[num_threads];
+    tim_data_t data[num_threads];
+    int bounds[num_threads + 1];
+    for (int t = 0; t < num_threads; t++) {
+        bounds[t] = l + (int)((long)n * t / num_threads);
+        data[t].arr = arr;
+        data[t].left = bounds[t];
+        data[t].right = l + (int)((long)n * (t + 1) / num_threads) - 1;
+        pthread_create(&threads[t], NULL, tim_sort_worker, &data[t]);
+    }
+    bounds[num_threads] = r + 1;
+    for (int t = 0; t < num_threads; t++)
+        pthread_join(threads[t], NULL);
+
+    int ordered = 1;
+    for (int t = 1; t < num_threads; t++)
+        if (arr[bounds[t] - 1] > arr[bounds[t]]) ordered = 0;
+    if (!ordered)
+        merge_p_kway(arr, bounds, num_threads, num_threads);
+}
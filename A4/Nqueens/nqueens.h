@@ -3,6 +3,7 @@
 #include <stdbool.h>
 #include <math.h>
 #include <omp.h>
+#include "../../common/nqueens_bits.h"
 
 bool isSafe(int board[], int row, int col, int n) 
 {
@@ -54,13 +55,10 @@ void solveNQueensUtil(int board[], int col, int n) {
             }
         }
     } else {
-        // Sequential recursion for deeper columns
-        for (int i = 0; i < n; i++) {
-            if (isSafe(board, i, col, n)) {
-                board[col] = i;
-                solveNQueensUtil(board, col + 1, n);
-            }
-        }
+        // Deeper columns: bitboard kernel, no recursion (n <= NQUEENS_MAX)
+        unsigned int cols, ld, rd;
+        if (nqueensMasks(n, board, col, &cols, &ld, &rd))
+            nqueensEnumerate(n, board, col, cols, ld, rd, printBoard);
     }
 }
 
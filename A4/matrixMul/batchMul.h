@@ -0,0 +1,139 @@
+#ifndef BATCH_MUL_H
+#define BATCH_MUL_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <omp.h>
+
+#define BATCH_LANES 16   // matrices multiplied side by side in one SIMD group
+#define BATCH_MAX_N 64   // largest size with a specialised kernel
+
+// Interleaved layout: a group holds BATCH_LANES matrices of size n x n, and
+// element (i, j) of matrix l lives at group[(i * n + j) * BATCH_LANES + l].
+// The innermost loop therefore runs across the batch, so every SIMD lane
+// works on a different matrix and no horizontal reductions are needed.
+
+static inline __attribute__((always_inline))
+void batchKernel(const int* restrict A, const int* restrict B, int* restrict C, int n)
+{
+    for (int i = 0; i < n; i++) {
+        int* c = C + i * n * BATCH_LANES;
+        for (int x = 0; x < n * BATCH_LANES; x++)
+            c[x] = 0;
+
+        for (int k = 0; k < n; k++) {
+            const int* a = A + (i * n + k) * BATCH_LANES;
+            const int* b = B + k * n * BATCH_LANES;
+            for (int j = 0; j < n; j++) {
+                #pragma omp simd
+                for (int l = 0; l < BATCH_LANES; l++)
+                    c[j * BATCH_LANES + l] += a[l] * b[j * BATCH_LANES + l];
+            }
+        }
+    }
+}
+
+// Fixed-size kernels: n is a compile-time constant, so the compiler can
+// fully unroll the j/k loops for the small sizes
+#define DEFINE_BATCH_KERNEL(SZ) \
+static void batchKernel##SZ(const int* restrict A, const int* restrict B, int* restrict C) \
+{ \
+    batchKernel(A, B, C, SZ); \
+}
+
+DEFINE_BATCH_KERNEL(4)
+DEFINE_BATCH_KERNEL(8)
+DEFINE_BATCH_KERNEL(16)
+DEFINE_BATCH_KERNEL(32)
+DEFINE_BATCH_KERNEL(64)
+
+static void batchKernelAny(const int* A, const int* B, int* C, int n)
+{
+    switch (n) {
+        case 4:  batchKernel4(A, B, C);  break;
+        case 8:  batchKernel8(A, B, C);  break;
+        case 16: batchKernel16(A, B, C); break;
+        case 32: batchKernel32(A, B, C); break;
+        case 64: batchKernel64(A, B, C); break;
+        default: batchKernel(A, B, C, n); break;
+    }
+}
+
+// Copy up to BATCH_LANES row-major matrices (stride ints apart) into one
+// interleaved group; unused lanes are zero-filled
+void batchPack(const int* src, long stride, int count, int n, int* group)
+{
+    for (int x = 0; x < n * n; x++) {
+        for (int l = 0; l < count; l++)
+            group[x * BATCH_LANES + l] = src[l * stride + x];
+        for (int l = count; l < BATCH_LANES; l++)
+            group[x * BATCH_LANES + l] = 0;
+    }
+}
+
+// Inverse of batchPack for the first count lanes of a group
+void batchUnpack(const int* group, int count, int n, int* dst, long stride)
+{
+    for (int x = 0; x < n * n; x++)
+        for (int l = 0; l < count; l++)
+            dst[l * stride + x] = group[x * BATCH_LANES + l];
+}
+
+// C = A * B for data that is already in interleaved layout; groups is the
+// number of BATCH_LANES-wide groups
+void batchMatrixMultiplyInterleaved(const int* A, const int* B, int* C, int n, long groups)
+{
+    long groupSize = (long)n * n * BATCH_LANES;
+
+    #pragma omp parallel for schedule(static)
+    for (long g = 0; g < groups; g++)
+        batchKernelAny(A + g * groupSize, B + g * groupSize, C + g * groupSize, n);
+}
+
+// C[b] = A[b] * B[b] for b = 0..batch-1, where matrix b of each operand is
+// row-major n x n starting at X + b * strideX. Each thread packs its chunk
+// into interleaved groups, multiplies, and scatters the results back.
+// Returns -1 (C untouched) if a thread's scratch space can't be allocated.
+int batchMatrixMultiply(const int* A, long strideA, const int* B, long strideB,
+                        int* C, long strideC, int n, long batch)
+{
+    long groups = (batch + BATCH_LANES - 1) / BATCH_LANES;
+    long groupSize = (long)n * n * BATCH_LANES;
+    int failed = 0;
+
+    #pragma omp parallel
+    {
+        int* gA = (int*)malloc(3 * groupSize * sizeof(int));
+        int* gB = gA + groupSize;
+        int* gC = gB + groupSize;
+        if (!gA) {
+            #pragma omp atomic write
+            failed = 1;
+        }
+        #pragma omp barrier
+
+        #pragma omp for schedule(static)
+        for (long g = 0; g < groups; g++) {
+            if (failed)
+                continue;
+            long first = g * BATCH_LANES;
+            int count = (batch - first < BATCH_LANES) ? (int)(batch - first) : BATCH_LANES;
+
+            batchPack(A + first * strideA, strideA, count, n, gA);
+            batchPack(B + first * strideB, strideB, count, n, gB);
+            batchKernelAny(gA, gB, gC, n);
+            batchUnpack(gC, count, n, C + first * strideC, strideC);
+        }
+
+        free(gA);
+    }
+
+    if (failed) {
+        printf("Memory allocation failed!\n");
+        return -1;
+    }
+    return 0;
+}
+
+#endif
@@ -0,0 +1,74 @@
+#include <time.h>
+#include "matrixMul.h"
+#include "batchMul.h"
+
+#define BATCH 100000           // max matrices per size
+#define BATCH_MEM (1 << 22)    // cap on ints per operand array
+
+int main()
+{
+    int sizes[] = {4, 8, 16, 32, 64};
+    int numSizes = sizeof(sizes) / sizeof(sizes[0]);
+
+    srand(time(NULL));
+
+    for (int s = 0; s < numSizes; s++) {
+        int n = sizes[s];
+        long stride = (long)n * n;
+        long batch = BATCH_MEM / stride;
+        if (batch > BATCH) batch = BATCH;
+
+        int* A  = (int*)malloc(batch * stride * sizeof(int));
+        int* B  = (int*)malloc(batch * stride * sizeof(int));
+        int* C1 = (int*)malloc(batch * stride * sizeof(int));
+        int* C2 = (int*)malloc(batch * stride * sizeof(int));
+        int** rows = (int**)malloc(3 * n * sizeof(int*));
+
+        if (!A || !B || !C1 || !C2 || !rows) {
+            printf("Memory allocation failed!\n");
+            return -1;
+        }
+
+        for (long x = 0; x < batch * stride; x++) {
+            A[x] = rand() % 10;
+            B[x] = rand() % 10;
+        }
+
+        // Baseline: one matrixMultiply call per matrix through int** views
+        double start = omp_get_wtime();
+        for (long b = 0; b < batch; b++) {
+            for (int i = 0; i < n; i++) {
+                rows[i]         = A  + b * stride + i * n;
+                rows[n + i]     = B  + b * stride + i * n;
+                rows[2 * n + i] = C1 + b * stride + i * n;
+            }
+            matrixMultiply(rows, rows + n, rows + 2 * n, n);
+        }
+        double loopTime = omp_get_wtime() - start;
+
+        start = omp_get_wtime();
+        if (batchMatrixMultiply(A, stride, B, stride, C2, stride, n, batch) != 0)
+            return -1;
+        double batchTime = omp_get_wtime() - start;
+
+        int errors = 0;
+        for (long x = 0; x < batch * stride; x++) {
+            if (C1[x] != C2[x]) {
+                errors++;
+                break;
+            }
+        }
+
+        printf("n=%2d batch=%6ld | loop: %12.0f mat/s | batched: %12.0f mat/s | speedup %.1fx %s\n",
+               n, batch, batch / loopTime, batch / batchTime, loopTime / batchTime,
+               errors ? "(MISMATCH)" : "");
+
+        free(A);
+        free(B);
+        free(C1);
+        free(C2);
+        free(rows);
+    }
+
+    return 0;
+}
@@ -0,0 +1,117 @@
+#include <time.h>
+#include "matrixMul.h"
+#include "matrixKernels.h"
+
+#define WORK (1L << 28)   // multiply-adds per small-size test
+
+// Runtime-n reference on flat matrices, same loop as matrixMultiply
+void matrixMultiplyFlat(const int* A, const int* B, int* C, int n)
+{
+    for (int i = 0; i < n; i++)
+        for (int j = 0; j < n; j++) {
+            int sum = 0;
+            for (int k = 0; k < n; k++)
+                sum += A[i * n + k] * B[k * n + j];
+            C[i * n + j] = sum;
+        }
+}
+
+int main()
+{
+    int sizes[] = {2, 4, 8, 16, 32};
+    int numSizes = sizeof(sizes) / sizeof(sizes[0]);
+
+    srand(time(NULL));
+
+    // Small sizes: many independent products, GOP/s counts one multiply
+    // and one add per inner iteration
+    for (int s = 0; s < numSizes; s++) {
+        int n = sizes[s];
+        long stride = (long)n * n;
+        long batch = (1L << 15) / stride;   // keep operands cache resident
+        if (batch < 1) batch = 1;
+        int reps = (int)(WORK / (batch * stride * n));
+        if (reps < 1) reps = 1;
+
+        int* A  = (int*)malloc(batch * stride * sizeof(int));
+        int* B  = (int*)malloc(batch * stride * sizeof(int));
+        int* C1 = (int*)malloc(batch * stride * sizeof(int));
+        int* C2 = (int*)malloc(batch * stride * sizeof(int));
+
+        for (long x = 0; x < batch * stride; x++) {
+            A[x] = rand() % 10;
+            B[x] = rand() % 10;
+        }
+
+        double start = omp_get_wtime();
+        for (int r = 0; r < reps; r++)
+            for (long b = 0; b < batch; b++)
+                matrixMultiplyFlat(A + b * stride, B + b * stride, C1 + b * stride, n);
+        double runtimeTime = omp_get_wtime() - start;
+
+        start = omp_get_wtime();
+        for (int r = 0; r < reps; r++)
+            matMulFixedBatch(A, B, C2, n, batch);
+        double fixedTime = omp_get_wtime() - start;
+
+        int errors = 0;
+        for (long x = 0; x < batch * stride; x++)
+            if (C1[x] != C2[x]) errors++;
+
+        double ops = 2.0 * n * n * n * batch * reps;
+        printf("n=%2d | runtime-n: %6.2f GOP/s | template: %6.2f GOP/s | speedup %.1fx %s\n",
+               n, ops / runtimeTime / 1e9, ops / fixedTime / 1e9, runtimeTime / fixedTime,
+               errors ? "(MISMATCH)" : "");
+
+        free(A);
+        free(B);
+        free(C1);
+        free(C2);
+    }
+
+    // Large size: int** matrixMultiply against the blocked kernel
+    int n = N;
+    int** A = (int**)malloc(n * sizeof(int*));
+    int** B = (int**)malloc(n * sizeof(int*));
+    int** C = (int**)malloc(n * sizeof(int*));
+    int* flatA = (int*)malloc((long)n * n * sizeof(int));
+    int* flatB = (int*)malloc((long)n * n * sizeof(int));
+    int* flatC = (int*)malloc((long)n * n * sizeof(int));
+
+    for (int i = 0; i < n; ++i) {
+        A[i] = flatA + (long)i * n;
+        B[i] = flatB + (long)i * n;
+        C[i] = (int*)malloc(n * sizeof(int));
+        for (int j = 0; j < n; ++j) {
+            A[i][j] = rand() % 10;
+            B[i][j] = rand() % 10;
+        }
+    }
+
+    double start = omp_get_wtime();
+    matrixMultiply(A, B, C, n);
+    double loopTime = omp_get_wtime() - start;
+
+    start = omp_get_wtime();
+    matMulFixed(flatA, flatB, flatC, n);
+    double blockedTime = omp_get_wtime() - start;
+
+    int errors = 0;
+    for (int i = 0; i < n; ++i)
+        for (int j = 0; j < n; ++j)
+            if (C[i][j] != flatC[(long)i * n + j]) errors++;
+
+    printf("n=%d | matrixMultiply: %.4f sec | blocked: %.4f sec | speedup %.1fx %s\n",
+           n, loopTime, blockedTime, loopTime / blockedTime, errors ? "(MISMATCH)" : "");
+
+    for (int i = 0; i < n; ++i)
+        free(C[i]);
+    free(A);
+    free(B);
+    free(C);
+    free(flatA);
+    free(flatB);
+    free(flatC);
+
+    return 0;
+}
@@ -1,4 +1,5 @@
 #include "matrixMul.h"
+#include "../../common/freivalds.h"
 
 int main() 
 {
@@ -35,6 +36,9 @@ int main()
 
     printf("Matrix multiplication complete!\n");
 
+    int ok = freivaldsVerify(A, B, C, N, FREIVALDS_ROUNDS);
+    printf("Verification (%d Freivalds rounds): %s\n", FREIVALDS_ROUNDS, ok == FREIVALDS_NOMEM ? "not run (out of memory)" : ok ? "passed" : "FAILED");
+
     // Optionally display the resulting matrix C
     printf("Resulting Matrix C:\n");
     displayMatrix(C, N);
@@ -0,0 +1,111 @@
+#include <time.h>
+#include "matrixMul.h"
+#include "sparseMul.h"
+
+#define SN 1000        // sparse test matrix size
+#define DENSITY 3      // percent of nonzero entries in A
+
+int main()
+{
+    srand(time(NULL));
+
+    int** A  = (int**)malloc(SN * sizeof(int*));
+    int** B  = (int**)malloc(SN * sizeof(int*));
+    int** C1 = (int**)malloc(SN * sizeof(int*));
+    int** C2 = (int**)malloc(SN * sizeof(int*));
+    int* x  = (int*)malloc(SN * sizeof(int));
+    int* y1 = (int*)malloc(SN * sizeof(int));
+    int* y2 = (int*)malloc(SN * sizeof(int));
+    int* y3 = (int*)malloc(SN * sizeof(int));
+
+    for (int i = 0; i < SN; ++i) {
+        A[i]  = (int*)malloc(SN * sizeof(int));
+        B[i]  = (int*)malloc(SN * sizeof(int));
+        C1[i] = (int*)malloc(SN * sizeof(int));
+        C2[i] = (int*)malloc(SN * sizeof(int));
+    }
+
+    // A is mostly zeros, B and x are dense
+    for (int i = 0; i < SN; ++i) {
+        x[i] = rand() % 10;
+        for (int j = 0; j < SN; ++j) {
+            A[i][j] = (rand() % 100 < DENSITY) ? 1 + rand() % 9 : 0;
+            B[i][j] = rand() % 10;
+        }
+    }
+
+    double start = omp_get_wtime();
+    csr_t S;
+    ell_t E;
+    if (csrFromDense(A, SN, SN, &S) != 0)
+        return -1;
+    if (ellFromCsr(&S, &E) != 0) {
+        csrFree(&S);
+        return -1;
+    }
+    printf("Converted %dx%d matrix: nnz=%d (%.2f%%), ELL width=%d, %.4f sec\n",
+           SN, SN, S.nnz, 100.0 * S.nnz / ((double)SN * SN), E.width, omp_get_wtime() - start);
+
+    // Matrix-vector
+    start = omp_get_wtime();
+    for (int i = 0; i < SN; i++) {
+        int sum = 0;
+        for (int j = 0; j < SN; j++)
+            sum += A[i][j] * x[j];
+        y1[i] = sum;
+    }
+    double denseMV = omp_get_wtime() - start;
+
+    start = omp_get_wtime();
+    if (csrSpMV(&S, x, y2) != 0)
+        return -1;
+    double csrMV = omp_get_wtime() - start;
+
+    start = omp_get_wtime();
+    ellSpMV(&E, x, y3);
+    double ellMV = omp_get_wtime() - start;
+
+    int errors = 0;
+    for (int i = 0; i < SN; i++)
+        if (y1[i] != y2[i] || y1[i] != y3[i]) errors++;
+
+    printf("Dense MV: %.6f sec | CSR SpMV: %.6f sec | ELL SpMV: %.6f sec %s\n",
+           denseMV, csrMV, ellMV, errors ? "(MISMATCH)" : "");
+
+    // Matrix-matrix
+    start = omp_get_wtime();
+    matrixMultiply(A, B, C1, SN);
+    double denseMM = omp_get_wtime() - start;
+
+    start = omp_get_wtime();
+    if (csrSpMM(&S, B, C2, SN) != 0)
+        return -1;
+    double csrMM = omp_get_wtime() - start;
+
+    errors = 0;
+    for (int i = 0; i < SN; i++)
+        for (int j = 0; j < SN; j++)
+            if (C1[i][j] != C2[i][j]) errors++;
+
+    printf("Dense MM: %.4f sec | CSR SpMM: %.4f sec | speedup %.1fx %s\n",
+           denseMM, csrMM, denseMM / csrMM, errors ? "(MISMATCH)" : "");
+
+    csrFree(&S);
+    ellFree(&E);
+    for (int i = 0; i < SN; ++i) {
+        free(A[i]);
+        free(B[i]);
+        free(C1[i]);
+        free(C2[i]);
+    }
+    free(A);
+    free(B);
+    free(C1);
+    free(C2);
+    free(x);
+    free(y1);
+    free(y2);
+    free(y3);
+
+    return 0;
+}
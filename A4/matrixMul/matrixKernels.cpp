@@ -0,0 +1,48 @@
+#include "matrixKernels.hpp"
+#include "matrixKernels.h"
+
+// Square sizes that get their own fully specialised kernel
+#define MK_FIXED_SIZES(X) X(2) X(3) X(4) X(5) X(6) X(8) X(12) X(16) X(24) X(32)
+
+namespace {
+
+template <int S>
+void batchFixed(const int* A, const int* B, int* C, long batch)
+{
+    constexpr long stride = (long)S * S;
+
+    #pragma omp parallel for schedule(static) if (batch * stride * S > (1L << 21))
+    for (long b = 0; b < batch; b++)
+        mk::matmul<S, S, S>(A + b * stride, B + b * stride, C + b * stride);
+}
+
+} // namespace
+
+extern "C" void matMulFixed(const int* A, const int* B, int* C, int n)
+{
+    switch (n) {
+#define MK_CASE(S) case S: mk::matmul<S, S, S>(A, B, C); return;
+    MK_FIXED_SIZES(MK_CASE)
+#undef MK_CASE
+    default:
+        mk::matmulBlocked(A, B, C, n, n, n);
+    }
+}
+
+extern "C" void matMulFixedBatch(const int* A, const int* B, int* C, int n, long batch)
+{
+    switch (n) {
+#define MK_CASE(S) case S: batchFixed<S>(A, B, C, batch); return;
+    MK_FIXED_SIZES(MK_CASE)
+#undef MK_CASE
+    default:
+        long stride = (long)n * n;
+        for (long b = 0; b < batch; b++)
+            mk::matmulBlocked(A + b * stride, B + b * stride, C + b * stride, n, n, n);
+    }
+}
+
+extern "C" void matMulBlocked(const int* A, const int* B, int* C, int m, int n, int k)
+{
+    mk::matmulBlocked(A, B, C, m, n, k);
+}
@@ -0,0 +1,28 @@
+#ifndef MATRIX_KERNELS_H
+#define MATRIX_KERNELS_H
+
+// C interface to the template kernels in matrixKernels.hpp.
+// Build: g++ -std=c++17 -O3 -march=native -fopenmp -c matrixKernels.cpp
+//        gcc -O3 -fopenmp mainKernels.c matrixKernels.o -lstdc++
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// C = A * B for flat row-major n x n matrices. Uses a compile-time
+// specialised kernel when n is 2, 3, 4, 5, 6, 8, 12, 16, 24 or 32, and
+// the blocked runtime kernel otherwise.
+void matMulFixed(const int* A, const int* B, int* C, int n);
+
+// Same product over batch independent matrices stored back to back;
+// the size dispatch happens once, outside the loop
+void matMulFixedBatch(const int* A, const int* B, int* C, int n, long batch);
+
+// Blocked runtime kernel: C (m x n) = A (m x k) * B (k x n)
+void matMulBlocked(const int* A, const int* B, int* C, int m, int n, int k);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
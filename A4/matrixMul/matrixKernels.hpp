@@ -0,0 +1,112 @@
+#ifndef MATRIX_KERNELS_HPP
+#define MATRIX_KERNELS_HPP
+
+// Header-only C++17 matrix kernels on flat row-major int matrices.
+// matmul<M, N, K> computes C (M x N) = A (M x K) * B (K x N): small shapes
+// are unrolled completely at compile time, mid-sized ones keep a row of C
+// in registers, and anything wider goes to the blocked runtime kernel.
+// C code reaches these through matrixKernels.h.
+
+#include <utility>
+#include <type_traits>
+
+namespace mk {
+
+constexpr int UNROLL_LIMIT = 8 * 8 * 8;  // max M*N*K for full unrolling
+constexpr int ROW_LIMIT = 64;            // max N for a register-resident row of C
+constexpr int BLOCK = 64;                // cache block for the runtime kernel
+
+#define MK_INLINE inline __attribute__((always_inline))
+
+// Call f(std::integral_constant<int, 0>) ... f(std::integral_constant<int, Count-1>)
+template <typename F, int... Is>
+MK_INLINE void unrollImpl(F& f, std::integer_sequence<int, Is...>)
+{
+    (f(std::integral_constant<int, Is>{}), ...);
+}
+
+template <int Count, typename F>
+MK_INLINE void unroll(F&& f)
+{
+    unrollImpl(f, std::make_integer_sequence<int, Count>{});
+}
+
+// Every index is a constant, so each row of C lives in registers and
+// the whole product is straight-line multiply-adds
+template <int M, int N, int K>
+MK_INLINE void matmulUnrolled(const int* __restrict A, const int* __restrict B, int* __restrict C)
+{
+    unroll<M>([&](auto i) {
+        int acc[N] = {};
+        unroll<K>([&](auto k) {
+            const int a = A[i * K + k];
+            unroll<N>([&](auto j) { acc[j] += a * B[k * N + j]; });
+        });
+        unroll<N>([&](auto j) { C[i * N + j] = acc[j]; });
+    });
+}
+
+// Mid-sized shapes: i and k stay loops (the code would get too large
+// otherwise) but each row of C is still held in registers across k
+template <int M, int N, int K>
+MK_INLINE void matmulRowUnrolled(const int* __restrict A, const int* __restrict B, int* __restrict C)
+{
+    for (int i = 0; i < M; i++) {
+        int acc[N] = {};
+        for (int k = 0; k < K; k++) {
+            const int a = A[i * K + k];
+            #pragma omp simd
+            for (int j = 0; j < N; j++)
+                acc[j] += a * B[k * N + j];
+        }
+        for (int j = 0; j < N; j++)
+            C[i * N + j] = acc[j];
+    }
+}
+
+// Cache-blocked i-k-j kernel for sizes only known at runtime
+inline void matmulBlocked(const int* __restrict A, const int* __restrict B, int* __restrict C,
+                          int m, int n, int k)
+{
+    #pragma omp parallel for schedule(static) if ((long)m * n * k > (1L << 21))
+    for (int i0 = 0; i0 < m; i0 += BLOCK) {
+        int iEnd = (i0 + BLOCK < m) ? i0 + BLOCK : m;
+        for (int i = i0; i < iEnd; i++)
+            for (int j = 0; j < n; j++)
+                C[i * n + j] = 0;
+
+        for (int k0 = 0; k0 < k; k0 += BLOCK) {
+            int kEnd = (k0 + BLOCK < k) ? k0 + BLOCK : k;
+            for (int j0 = 0; j0 < n; j0 += BLOCK) {
+                int jEnd = (j0 + BLOCK < n) ? j0 + BLOCK : n;
+                for (int i = i0; i < iEnd; i++) {
+                    int* c = C + i * n;
+                    for (int kk = k0; kk < kEnd; kk++) {
+                        const int a = A[i * k + kk];
+                        const int* b = B + kk * n;
+                        #pragma omp simd
+                        for (int j = j0; j < jEnd; j++)
+                            c[j] += a * b[j];
+                    }
+                }
+            }
+        }
+    }
+}
+
+template <int M, int N, int K>
+MK_INLINE void matmul(const int* __restrict A, const int* __restrict B, int* __restrict C)
+{
+    if constexpr (M * N * K <= UNROLL_LIMIT)
+        matmulUnrolled<M, N, K>(A, B, C);
+    else if constexpr (N <= ROW_LIMIT)
+        matmulRowUnrolled<M, N, K>(A, B, C);
+    else
+        matmulBlocked(A, B, C, M, N, K);
+}
+
+#undef MK_INLINE
+
+} // namespace mk
+
+#endif
@@ -0,0 +1,232 @@
+#ifndef SPARSE_MUL_H
+#define SPARSE_MUL_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <omp.h>
+
+// Compressed Sparse Row: the nonzeros of row i are val[row_ptr[i] .. row_ptr[i+1]-1]
+// with their column numbers in col_idx
+typedef struct {
+    int rows, cols;
+    int nnz;
+    int* row_ptr;   // rows + 1 entries
+    int* col_idx;   // nnz entries
+    int* val;       // nnz entries
+} csr_t;
+
+// ELLPACK: every row padded to width entries, stored column-major so that
+// consecutive rows are contiguous; padding has col_idx = -1
+typedef struct {
+    int rows, cols;
+    int width;
+    int* col_idx;   // width * rows entries
+    int* val;       // width * rows entries
+} ell_t;
+
+void csrFree(csr_t* A)
+{
+    free(A->row_ptr);
+    free(A->col_idx);
+    free(A->val);
+    A->row_ptr = A->col_idx = A->val = NULL;
+}
+
+// Build CSR from M into *out; returns -1 (with *out left empty) if an
+// allocation fails
+int csrFromDense(int** M, int rows, int cols, csr_t* out)
+{
+    csr_t A = {rows, cols, 0, NULL, NULL, NULL};
+    *out = A;
+    A.row_ptr = (int*)malloc((rows + 1) * sizeof(int));
+    if (A.row_ptr == NULL) {
+        printf("Memory allocation failed!\n");
+        return -1;
+    }
+
+    A.row_ptr[0] = 0;
+    for (int i = 0; i < rows; i++) {
+        int count = 0;
+        for (int j = 0; j < cols; j++)
+            if (M[i][j] != 0) count++;
+        A.row_ptr[i + 1] = A.row_ptr[i] + count;
+    }
+    A.nnz = A.row_ptr[rows];
+
+    A.col_idx = (int*)malloc(A.nnz * sizeof(int));
+    A.val = (int*)malloc(A.nnz * sizeof(int));
+    if ((A.col_idx == NULL || A.val == NULL) && A.nnz > 0) {
+        printf("Memory allocation failed!\n");
+        csrFree(&A);
+        return -1;
+    }
+
+    #pragma omp parallel for schedule(static)
+    for (int i = 0; i < rows; i++) {
+        int p = A.row_ptr[i];
+        for (int j = 0; j < cols; j++) {
+            if (M[i][j] != 0) {
+                A.col_idx[p] = j;
+                A.val[p] = M[i][j];
+                p++;
+            }
+        }
+    }
+    *out = A;
+    return 0;
+}
+
+// Split the rows into parts ranges holding roughly nnz / parts nonzeros each;
+// range t is bounds[t] .. bounds[t+1]-1. Plain row splitting lets one
+// thread end up with all the dense rows.
+void csrBalancedSplit(const csr_t* A, int parts, int* bounds)
+{
+    bounds[0] = 0;
+    for (int t = 1; t < parts; t++) {
+        long target = (long)A->nnz * t / parts;
+        int lo = bounds[t - 1], hi = A->rows;
+        // first row whose starting offset reaches the target
+        while (lo < hi) {
+            int mid = lo + (hi - lo) / 2;
+            if (A->row_ptr[mid] < target) lo = mid + 1;
+            else hi = mid;
+        }
+        bounds[t] = lo;
+    }
+    bounds[parts] = A->rows;
+}
+
+// y = A * x; returns -1 if scratch space can't be allocated
+int csrSpMV(const csr_t* A, const int* x, int* y)
+{
+    // The team may come out smaller than the maximum (nesting, OMP_DYNAMIC,
+    // thread limits), so split for the team actually formed
+    int* bounds = (int*)malloc((omp_get_max_threads() + 1) * sizeof(int));
+    if (!bounds) {
+        printf("Memory allocation failed!\n");
+        return -1;
+    }
+
+    #pragma omp parallel
+    {
+        #pragma omp single
+        csrBalancedSplit(A, omp_get_num_threads(), bounds);
+
+        int t = omp_get_thread_num();
+        for (int i = bounds[t]; i < bounds[t + 1]; i++) {
+            int sum = 0;
+            for (int p = A->row_ptr[i]; p < A->row_ptr[i + 1]; p++)
+                sum += A->val[p] * x[A->col_idx[p]];
+            y[i] = sum;
+        }
+    }
+    free(bounds);
+    return 0;
+}
+
+// C = A * B with A sparse (rows x k) and B, C dense (k x n and rows x n);
+// returns -1 if scratch space can't be allocated
+int csrSpMM(const csr_t* A, int** B, int** C, int n)
+{
+    // The team may come out smaller than the maximum (nesting, OMP_DYNAMIC,
+    // thread limits), so split for the team actually formed
+    int* bounds = (int*)malloc((omp_get_max_threads() + 1) * sizeof(int));
+    if (!bounds) {
+        printf("Memory allocation failed!\n");
+        return -1;
+    }
+
+    #pragma omp parallel
+    {
+        #pragma omp single
+        csrBalancedSplit(A, omp_get_num_threads(), bounds);
+
+        int t = omp_get_thread_num();
+        for (int i = bounds[t]; i < bounds[t + 1]; i++) {
+            int* c = C[i];
+            for (int j = 0; j < n; j++)
+                c[j] = 0;
+            // each nonzero scales one row of B into the output row
+            for (int p = A->row_ptr[i]; p < A->row_ptr[i + 1]; p++) {
+                int a = A->val[p];
+                const int* b = B[A->col_idx[p]];
+                #pragma omp simd
+                for (int j = 0; j < n; j++)
+                    c[j] += a * b[j];
+            }
+        }
+    }
+    free(bounds);
+    return 0;
+}
+
+// Pad A out to ELLPACK in *out; returns -1 (with *out left empty) if an
+// allocation fails
+int ellFromCsr(const csr_t* A, ell_t* out)
+{
+    ell_t E = {A->rows, A->cols, 0, NULL, NULL};
+    *out = E;
+    for (int i = 0; i < A->rows; i++) {
+        int len = A->row_ptr[i + 1] - A->row_ptr[i];
+        if (len > E.width) E.width = len;
+    }
+
+    E.col_idx = (int*)malloc((long)E.width * E.rows * sizeof(int));
+    E.val = (int*)malloc((long)E.width * E.rows * sizeof(int));
+    if ((E.col_idx == NULL || E.val == NULL) && (long)E.width * E.rows > 0) {
+        printf("Memory allocation failed!\n");
+        free(E.col_idx);
+        free(E.val);
+        return -1;
+    }
+
+    #pragma omp parallel for schedule(static)
+    for (int i = 0; i < A->rows; i++) {
+        int len = A->row_ptr[i + 1] - A->row_ptr[i];
+        for (int s = 0; s < E.width; s++) {
+            long at = (long)s * E.rows + i;
+            if (s < len) {
+                E.col_idx[at] = A->col_idx[A->row_ptr[i] + s];
+                E.val[at] = A->val[A->row_ptr[i] + s];
+            } else {
+                E.col_idx[at] = -1;
+                E.val[at] = 0;
+            }
+        }
+    }
+    *out = E;
+    return 0;
+}
+
+void ellFree(ell_t* E)
+{
+    free(E->col_idx);
+    free(E->val);
+    E->col_idx = E->val = NULL;
+}
+
+// y = E * x; only worthwhile when row lengths are close to uniform,
+// since every row pays for the longest one
+void ellSpMV(const ell_t* E, const int* x, int* y)
+{
+    #pragma omp parallel
+    {
+        int t = omp_get_thread_num(), nt = omp_get_num_threads();
+        int lo = (int)((long)E->rows * t / nt);
+        int hi = (int)((long)E->rows * (t + 1) / nt);
+
+        for (int i = lo; i < hi; i++)
+            y[i] = 0;
+        // walk slot by slot so each pass reads a contiguous run of rows
+        for (int s = 0; s < E->width; s++) {
+            const int* cols = E->col_idx + (long)s * E->rows;
+            const int* vals = E->val + (long)s * E->rows;
+            for (int i = lo; i < hi; i++)
+                if (cols[i] >= 0)
+                    y[i] += vals[i] * x[cols[i]];
+        }
+    }
+}
+
+#endif
@@ -1,38 +1,94 @@
 #include "sorts.h"
+#include <string.h>
+#include <omp.h>
 
-int main() 
+#define TOP_K 100   // how many of the smallest elements top_k returns
+
+int isSorted(int arr[], int n)
+{
+    for (int i = 1; i < n; i++)
+        if (arr[i - 1] > arr[i])
+            return 0;
+    return 1;
+}
+
+// ./mainSorts [n]: the merge sorts and selection run on n elements
+// (default SIZE), bubble sort on the first min(n, SIZE) of them
+int main(int argc, char *argv[]) 
 {
     srand(time(NULL));
+    int n = (argc > 1) ? atoi(argv[1]) : SIZE;
+    if (n < 1) {
+        fprintf(stderr, "Usage: %s [n >= 1]\n", argv[0]);
+        return 1;
+    }
+    int nBubble = (n < SIZE) ? n : SIZE;
 
     // Dynamically allocate arrays
-    int *arr1 = (int*)malloc(SIZE * sizeof(int));
-    int *arr2 = (int*)malloc(SIZE * sizeof(int));
+    int *arr1 = (int*)malloc(n * sizeof(int));
+    int *arr2 = (int*)malloc(n * sizeof(int));
+    int *arr3 = (int*)malloc(nBubble * sizeof(int));
+    int *arr4 = (int*)malloc(n * sizeof(int));   // selection input
+    int *topk = (int*)malloc(TOP_K * sizeof(int));
 
-    if (!arr1 || !arr2) {
+    if (!arr1 || !arr2 || !arr3 || !arr4 || !topk) {
         fprintf(stderr, "Memory allocation failed\n");
         return 1;
     }
 
     // Populate arrays with random values
-    for (int i = 0; i < SIZE; i++) {
+    for (int i = 0; i < n; i++) {
         int val = rand() % MAX_VAL;
         arr1[i] = val;
         arr2[i] = val;
+        arr4[i] = val;
+        if (i < nBubble)
+            arr3[i] = val;
     }
 
-    printf("Original array:\n");
-    printArray(arr1, SIZE);
+    double start = omp_get_wtime();
+    mergeSort(arr1, 0, n - 1);
+    double end = omp_get_wtime();
+    printf("Merge Sort (%d elements): %f seconds\n", n, end - start);
+
+    start = omp_get_wtime();
+    parallelMergeSort(arr2, 0, n - 1);
+    end = omp_get_wtime();
+    printf("Parallel Merge Sort (%d elements, %d threads): %f seconds\n",
+           n, omp_get_max_threads(), end - start);
+
+    start = omp_get_wtime();
+    bubbleSort(arr3, nBubble);
+    end = omp_get_wtime();
+    printf("Bubble Sort (%d elements): %f seconds\n", nBubble, end - start);
+
+    int ok = isSorted(arr1, n) && memcmp(arr1, arr2, n * sizeof(int)) == 0 && isSorted(arr3, nBubble);
+    printf("Verification: %s\n", ok ? "passed" : "FAILED");
 
-    mergeSort(arr1, 0, SIZE - 1);
-    printf("Sorted with Merge Sort:\n");
-    printArray(arr1, SIZE);
+    // Selection without a full sort, checked against the sorted arr1.
+    // select_nth reorders arr4, but it stays a permutation of the input,
+    // which is all top_k needs.
+    int k = n / 2;
+    start = omp_get_wtime();
+    int median = select_nth(arr4, n, k);
+    end = omp_get_wtime();
+    int selectOk = median == arr1[k] && select_nth(arr4, n, 0) == arr1[0] &&
+                   select_nth(arr4, n, n - 1) == arr1[n - 1];
+    printf("Select nth (median of %d elements): %f seconds, %s\n",
+           n, end - start, selectOk ? "passed" : "FAILED");
 
-    bubbleSort(arr2, SIZE);
-    printf("Sorted with Bubble Sort:\n");
-    printArray(arr2, SIZE);
+    int kTop = (n < TOP_K) ? n : TOP_K;
+    start = omp_get_wtime();
+    top_k(arr4, n, kTop, topk);
+    end = omp_get_wtime();
+    int topOk = memcmp(topk, arr1, kTop * sizeof(int)) == 0;
+    printf("Top %d of %d elements: %f seconds, %s\n", kTop, n, end - start, topOk ? "passed" : "FAILED");
 
     free(arr1);
     free(arr2);
+    free(arr3);
+    free(arr4);
+    free(topk);
 
     return 0;
 }
@@ -1,57 +1,431 @@
 #include "sorts.h"
+#include <string.h>
+#include <omp.h>
 
 // Merge Sort 
-static void merge(int arr[], int left, int mid, int right) 
+#define INSERTION_CUTOFF 32 // runs this short are insertion sorted
+
+static void insertionSort(int arr[], int left, int right)
+{
+	for (int i = left + 1; i <= right; i++) {
+		int key = arr[i];
+		int j = i - 1;
+		while (j >= left && arr[j] > key) {
+			arr[j + 1] = arr[j];
+			j--;
+		}
+		arr[j + 1] = key;
+	}
+}
+
+// Merge src[left..mid] and src[mid+1..right] into dst[left..right]
+static void merge(const int src[], int dst[], int left, int mid, int right) 
+{
+	int i = left, j = mid + 1, k = left;
+	while (i <= mid && j <= right) {
+		if (src[i] <= src[j])
+			dst[k++] = src[i++];
+		else
+			dst[k++] = src[j++];
+	}
+
+	// Copy whichever run has elements left
+	while (i <= mid)
+		dst[k++] = src[i++];
+	while (j <= right)
+		dst[k++] = src[j++];
+}
+
+// End (exclusive) of the run starting at lo. A strictly descending run is
+// reversed so that every run comes back ascending; equal elements never
+// start a descending run, which keeps the sort stable.
+static int findRun(int arr[], int lo, int n)
+{
+	int hi = lo + 1;
+	if (hi == n)
+		return hi;
+
+	if (arr[hi++] < arr[lo]) {
+		while (hi < n && arr[hi] < arr[hi - 1])
+			hi++;
+		for (int i = lo, j = hi - 1; i < j; i++, j--) {
+			int temp = arr[i];
+			arr[i] = arr[j];
+			arr[j] = temp;
+		}
+	} else {
+		while (hi < n && arr[hi] >= arr[hi - 1])
+			hi++;
+	}
+	return hi;
+}
+
+// Natural merge sort: cut the input into the runs it already has (runs
+// shorter than INSERTION_CUTOFF are extended by insertion sort), then merge
+// neighbouring runs pairwise, back and forth between arr and one scratch
+// buffer, until a single run is left. Sorted or reversed input is one run
+// and costs one O(n) scan; random input does the usual log n passes.
+void mergeSort(int arr[], int left, int right) 
+{
+	int n = right - left + 1;
+	if (n < 2)
+		return;
+
+	// Start of every run, plus n at the end. Every run but the last is at
+	// least INSERTION_CUTOFF long, which bounds how many there can be.
+	int* a = arr + left;
+	int* runs = malloc((n / INSERTION_CUTOFF + 2) * sizeof(int));
+	int count = 0;
+	for (int lo = 0; lo < n; ) {
+		int hi = findRun(a, lo, n);
+		if (hi - lo < INSERTION_CUTOFF) {
+			hi = (lo + INSERTION_CUTOFF < n) ? lo + INSERTION_CUTOFF : n;
+			insertionSort(a, lo, hi - 1);
+		}
+		runs[count++] = lo;
+		lo = hi;
+	}
+	runs[count] = n;
+
+	int* buf = (count > 1) ? malloc(n * sizeof(int)) : NULL;
+	int* src = a;
+	int* dst = buf;
+	while (count > 1) {
+		int merged = 0;
+		for (int r = 0; r < count; r += 2) {
+			if (r + 1 < count)
+				merge(src, dst, runs[r], runs[r + 1] - 1, runs[r + 2] - 1);
+			else
+				for (int i = runs[r]; i < n; i++)
+					dst[i] = src[i];
+			runs[merged++] = runs[r];
+		}
+		runs[merged] = n;
+		count = merged;
+
+		int* temp = src;
+		src = dst;
+		dst = temp;
+	}
+
+	// An odd number of passes leaves the result in the buffer
+	if (src != a)
+		for (int i = 0; i < n; i++)
+			a[i] = src[i];
+
+	free(runs);
+	free(buf);
+}
+
+// Task-parallel merge sort (OpenMP)
+#define TASK_CUTOFF 4096   // subarrays this short are sorted by one task
+#define MERGE_CUTOFF 8192  // merges this short are done by one task
+
+// Merge src[l1..r1] and src[l2..r2] into dst starting at d
+static void mergeRanges(const int src[], int l1, int r1, int l2, int r2, int dst[], int d)
+{
+	while (l1 <= r1 && l2 <= r2)
+		dst[d++] = (src[l2] < src[l1]) ? src[l2++] : src[l1++];
+	while (l1 <= r1)
+		dst[d++] = src[l1++];
+	while (l2 <= r2)
+		dst[d++] = src[l2++];
+}
+
+// Divide-and-conquer merge: the middle element of the longer run is placed
+// directly, a binary search splits the other run around it, and the two
+// halves are merged as independent tasks. The first run always wins ties,
+// so the merge is stable.
+static void taskMerge(const int src[], int l1, int r1, int l2, int r2, int dst[], int d)
+{
+	int n1 = r1 - l1 + 1, n2 = r2 - l2 + 1;
+	if (n1 + n2 <= MERGE_CUTOFF) {
+		mergeRanges(src, l1, r1, l2, r2, dst, d);
+		return;
+	}
+
+	int q1, q2;
+	if (n1 >= n2) {
+		q1 = l1 + n1 / 2;  // second run: first element >= src[q1]
+		int lo = l2, hi = r2 + 1;
+		while (lo < hi) {
+			int mid = lo + (hi - lo) / 2;
+			if (src[mid] < src[q1]) lo = mid + 1; else hi = mid;
+		}
+		q2 = lo;
+		int q3 = d + (q1 - l1) + (q2 - l2);
+		dst[q3] = src[q1];
+		#pragma omp task
+		taskMerge(src, l1, q1 - 1, l2, q2 - 1, dst, d);
+		taskMerge(src, q1 + 1, r1, q2, r2, dst, q3 + 1);
+	} else {
+		q2 = l2 + n2 / 2;  // first run: first element > src[q2]
+		int lo = l1, hi = r1 + 1;
+		while (lo < hi) {
+			int mid = lo + (hi - lo) / 2;
+			if (src[mid] <= src[q2]) lo = mid + 1; else hi = mid;
+		}
+		q1 = lo;
+		int q3 = d + (q1 - l1) + (q2 - l2);
+		dst[q3] = src[q2];
+		#pragma omp task
+		taskMerge(src, l1, q1 - 1, l2, q2 - 1, dst, d);
+		taskMerge(src, q1, r1, q2 + 1, r2, dst, q3 + 1);
+	}
+	#pragma omp taskwait
+}
+
+// Sort a[left..right], leaving the result in b if toB is set, else in a.
+// The halves are sorted into the other array and merged back, so the two
+// arrays swap roles each level and nothing is copied between merges.
+static void taskMergeSort(int a[], int b[], int left, int right, int toB)
+{
+	if (right - left + 1 <= TASK_CUTOFF) {
+		mergeSort(a, left, right);
+		if (toB)
+			memcpy(b + left, a + left, (right - left + 1) * sizeof(int));
+		return;
+	}
+
+	int mid = left + (right - left) / 2;
+	#pragma omp task
+	taskMergeSort(a, b, left, mid, !toB);
+	taskMergeSort(a, b, mid + 1, right, !toB);
+	#pragma omp taskwait
+
+	if (toB)
+		taskMerge(a, left, mid, mid + 1, right, b, left);
+	else
+		taskMerge(b, left, mid, mid + 1, right, a, left);
+}
+
+// Drop-in replacement for mergeSort: one scratch buffer of the same size on
+// the heap, sorting and merging split into OpenMP tasks
+void parallelMergeSort(int arr[], int left, int right)
 {
-	int n1 = mid - left + 1; // length of left subarray
-	int n2 = right - mid; // length of right subarray
+	int n = right - left + 1;
+	if (n <= TASK_CUTOFF) {
+		mergeSort(arr, left, right);
+		return;
+	}
+
+	int* buf = malloc(n * sizeof(int));
+	#pragma omp parallel
+	#pragma omp single
+	taskMergeSort(arr + left, buf, 0, n - 1, 0);
+	free(buf);
+}
+
+// Selection
+#define SELECT_CUTOFF 65536 // ranges shorter than this are partitioned sequentially
+
+static void swapInts(int arr[], int i, int j)
+{
+	int temp = arr[i];
+	arr[i] = arr[j];
+	arr[j] = temp;
+}
 
-	// Temp arrays
-	int L[n1], R[n2];
+static int medianOf3(int a, int b, int c)
+{
+	if (a < b)
+		return (b < c) ? b : (a < c ? c : a);
+	return (a < c) ? a : (b < c ? c : b);
+}
 
-	// Copying data to temp arrays
-	for (int i = 0; i < n1; i++)
-		L[i] = arr[left + i];
-	for (int j = 0; j < n2; j++)
-		R[j] = arr[mid + 1 + j];
+// Median of three medians of nine elements spread over arr[lo..hi]
+static int choosePivot(int arr[], int lo, int hi)
+{
+	int step = (hi - lo) / 8;
+	return medianOf3(medianOf3(arr[lo], arr[lo + step], arr[lo + 2 * step]),
+	                 medianOf3(arr[lo + 3 * step], arr[lo + 4 * step], arr[lo + 5 * step]),
+	                 medianOf3(arr[lo + 6 * step], arr[lo + 7 * step], arr[hi]));
+}
 
-	// Merge temp arrays back into arr[left..right]
-	int i = 0, j = 0, k = left;
-	while (i < n1 && j < n2) {
-		if (L[i] <= R[j]) {
-			arr[k] = L[i];
+// Three-way partition of arr[lo..hi] around pivot: afterwards
+// arr[lo..*lt-1] < pivot, arr[*lt..*gt] == pivot and arr[*gt+1..hi] > pivot
+static void partition3(int arr[], int lo, int hi, int pivot, int* lt, int* gt)
+{
+	int l = lo, i = lo, g = hi;
+	while (i <= g) {
+		if (arr[i] < pivot)
+			swapInts(arr, l++, i++);
+		else if (arr[i] > pivot)
+			swapInts(arr, i, g--);
+		else
 			i++;
-		} else {
-			arr[k] = R[j];
-			j++;
+	}
+	*lt = l;
+	*gt = g;
+}
+
+// The same partition in parallel: each thread counts the three classes in
+// its chunk, prefix sums over the counts give every thread its own slots in
+// scratch, and the chunks are scattered there and copied back.
+static void parallelPartition3(int arr[], int scratch[], int lo, int hi, int pivot, int* lt, int* gt)
+{
+	int n = hi - lo + 1;
+	int (*counts)[3] = malloc(omp_get_max_threads() * sizeof(*counts));
+	int less = 0, equal = 0;
+
+	#pragma omp parallel
+	{
+		int t = omp_get_thread_num();
+		int threads = omp_get_num_threads();
+		int start = lo + (int)((long)n * t / threads);
+		int end = lo + (int)((long)n * (t + 1) / threads);
+
+		int c[3] = {0, 0, 0};
+		for (int i = start; i < end; i++)
+			c[(arr[i] > pivot) + (arr[i] >= pivot)]++;  // 0 less, 1 equal, 2 greater
+		counts[t][0] = c[0];
+		counts[t][1] = c[1];
+		counts[t][2] = c[2];
+		#pragma omp barrier
+
+		int total[3] = {0, 0, 0}, before[3] = {0, 0, 0};
+		for (int u = 0; u < threads; u++)
+			for (int j = 0; j < 3; j++) {
+				if (u < t)
+					before[j] += counts[u][j];
+				total[j] += counts[u][j];
+			}
+		int offset[3] = {before[0], total[0] + before[1], total[0] + total[1] + before[2]};
+		for (int i = start; i < end; i++)
+			scratch[offset[(arr[i] > pivot) + (arr[i] >= pivot)]++] = arr[i];
+		#pragma omp barrier
+
+		for (int i = start; i < end; i++)
+			arr[i] = scratch[i - lo];
+		if (t == 0) {
+			less = total[0];
+			equal = total[1];
 		}
-		k++;
 	}
 
-	// Copy any remaining elements of L[]
-	while (i < n1) {
-		arr[k] = L[i];
-		i++;
-		k++;
+	free(counts);
+	*lt = lo + less;
+	*gt = lo + less + equal - 1;
+}
+
+// Introselect: rearrange arr so that arr[k] is the element a full sort
+// would put there, with nothing larger before it and nothing smaller after
+// it, and return it (0 <= k < n). Large ranges are partitioned in parallel.
+// If partitioning stops shrinking the range fast enough (2 log n rounds)
+// the rest is merge sorted, so the worst case stays O(n log n).
+int select_nth(int arr[], int n, int k)
+{
+	int lo = 0, hi = n - 1;
+	int depth = 0;
+	for (int m = n; m > 1; m /= 2)
+		depth += 2;
+
+	int* scratch = NULL;
+	while (hi > lo) {
+		if (hi - lo < INSERTION_CUTOFF) {
+			insertionSort(arr, lo, hi);
+			break;
+		}
+		if (depth-- == 0) {
+			mergeSort(arr, lo, hi);
+			break;
+		}
+
+		int pivot = choosePivot(arr, lo, hi);
+		int lt, gt;
+		if (hi - lo + 1 >= SELECT_CUTOFF) {
+			if (!scratch)
+				scratch = malloc(n * sizeof(int));
+			parallelPartition3(arr, scratch, lo, hi, pivot, &lt, &gt);
+		} else {
+			partition3(arr, lo, hi, pivot, &lt, &gt);
+		}
+
+		if (k < lt)
+			hi = lt - 1;
+		else if (k > gt)
+			lo = gt + 1;
+		else
+			break;  // k landed among the copies of the pivot
 	}
 
-	// Copy any remaining elements of R[]
-	while (j < n2) {
-		arr[k] = R[j];
-		j++;
-		k++;
+	free(scratch);
+	return arr[k];
+}
+
+// Max-heap of the k smallest seen so far, largest on top
+static void heapSiftDown(int heap[], int size, int i)
+{
+	int x = heap[i];
+	while (2 * i + 1 < size) {
+		int c = 2 * i + 1;
+		if (c + 1 < size && heap[c + 1] > heap[c])
+			c++;
+		if (heap[c] <= x)
+			break;
+		heap[i] = heap[c];
+		i = c;
 	}
+	heap[i] = x;
+}
 
+static void heapPush(int heap[], int size, int x)
+{
+	int i = size;
+	while (i > 0 && heap[(i - 1) / 2] < x) {
+		heap[i] = heap[(i - 1) / 2];
+		i = (i - 1) / 2;
+	}
+	heap[i] = x;
 }
 
-void mergeSort(int arr[], int left, int right) 
+// The k smallest elements of arr in ascending order in out[0..k); arr is
+// not modified and k is clamped to n. Each thread keeps a heap of the k
+// smallest in its share, which costs O(n log k) over all threads and only
+// touches the heap when an element beats its top; the thread heaps are
+// then combined with select_nth.
+void top_k(const int arr[], int n, int k, int out[])
 {
-    if (left < right) {
-        int mid = left + (right - left) / 2;
-        mergeSort(arr, left, mid);
-        mergeSort(arr, mid + 1, right);
-        merge(arr, left, mid, right);
-    }
+	if (k > n)
+		k = n;
+	if (k <= 0)
+		return;
+
+	int maxThreads = omp_get_max_threads();
+	int* heaps = malloc((long)maxThreads * k * sizeof(int));
+	int* sizes = calloc(maxThreads, sizeof(int));
+
+	#pragma omp parallel
+	{
+		int t = omp_get_thread_num();
+		int* heap = heaps + (long)t * k;
+		int size = 0;
+
+		#pragma omp for schedule(static)
+		for (int i = 0; i < n; i++) {
+			if (size < k)
+				heapPush(heap, size++, arr[i]);
+			else if (arr[i] < heap[0]) {
+				heap[0] = arr[i];
+				heapSiftDown(heap, k, 0);
+			}
+		}
+		sizes[t] = size;
+	}
+
+	// At most threads * k candidates, and every one of the k smallest is
+	// among them
+	int total = 0;
+	for (int t = 0; t < maxThreads; t++) {
+		memmove(heaps + total, heaps + (long)t * k, sizes[t] * sizeof(int));
+		total += sizes[t];
+	}
+	select_nth(heaps, total, k - 1);
+	mergeSort(heaps, 0, k - 1);
+	memcpy(out, heaps, k * sizeof(int));
+
+	free(heaps);
+	free(sizes);
 }
 
 // Bubble Sort
@@ -59,7 +433,7 @@ void bubbleSort(int arr[], int n)
 {
 	for (int i = 0; i < n-1; i++) {
 		// last i elements are already in palce
-		for (int j = 0; j < n-1; j++) {
+		for (int j = 0; j < n-1-i; j++) {
 			if (arr[j] > arr[j + 1]) {
 				// swap arr[j] and arr[j+1]
 				int temp = arr[j];
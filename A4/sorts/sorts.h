@@ -10,8 +10,13 @@
 #include <time.h>
 
 void mergeSort(int arr[], int left, int right);
+void parallelMergeSort(int arr[], int left, int right);  // OpenMP tasks
 void bubbleSort(int arr[], int n);
 
+// Selection without a full sort (OpenMP)
+int select_nth(int arr[], int n, int k);           // arr[k] as if sorted; partially reorders arr
+void top_k(const int arr[], int n, int k, int out[]);  // k smallest, ascending
+
 void printArray(int arr[], int n);
 
 #endif
@@ -1,5 +1,6 @@
 #include <mpi.h>
 #include "matrixMul.h"
+#include "../common/freivalds.h"
 
 int main(int argc, char* argv[]) {
     int rank, size;
@@ -72,8 +73,9 @@ int main(int argc, char* argv[]) {
         printf("Matrix size: %dx%d, Processes: %d\n", n, n, size);
         printf("Elapsed time: %f seconds\n", elapsed);
 
-        // Optional correctness check
-        // printf("Sample result (C[0][0]) = %d\n", C[0]);
+        // Correctness check, O(n^2) per round
+        int ok = freivaldsVerifyFlat(A, B, C, n, n, FREIVALDS_ROUNDS);
+        printf("Verification (%d Freivalds rounds): %s\n", FREIVALDS_ROUNDS, ok == FREIVALDS_NOMEM ? "not run (out of memory)" : ok ? "passed" : "FAILED");
     }
 
     // Free memory
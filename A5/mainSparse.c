@@ -0,0 +1,220 @@
+#include <mpi.h>
+#include <string.h>
+#include "sparseMul.h"
+
+#define N 1000      // Adjust for testing
+#define BAND 20     // nonzeros cluster within BAND of the diagonal
+#define ITERS 100   // SpMV repetitions, as in an iterative solver
+
+int main(int argc, char* argv[]) {
+    int rank, size;
+    int n = N;
+
+    MPI_Init(&argc, &argv);
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+    if (n % size != 0) {
+        if (rank == 0)
+            printf("Matrix size %d not divisible by number of processes %d!\n", n, size);
+        MPI_Finalize();
+        return 0;
+    }
+
+    int rows_per_proc = n / size;
+    int lo = rank * rows_per_proc;
+    int hi = lo + rows_per_proc;
+
+    int* x = NULL;
+    int* y = NULL;
+    int* row_len = NULL;
+    int* nnz_counts = NULL;
+    int* nnz_displs = NULL;
+    csr_t A = {0};
+
+    if (rank == 0) {
+        int* dense = (int*)malloc((long)n * n * sizeof(int));
+        x = (int*)malloc(n * sizeof(int));
+        y = (int*)malloc(n * sizeof(int));
+
+        // Banded matrix with a sprinkling of far-off entries
+        for (int i = 0; i < n; ++i) {
+            x[i] = rand() % 10;
+            for (int j = 0; j < n; ++j) {
+                int near = abs(i - j) <= BAND;
+                dense[i * n + j] = ((near && rand() % 2) || rand() % 1000 == 0) ? 1 + rand() % 9 : 0;
+            }
+        }
+
+        int status = csrFromFlat(dense, n, n, &A);
+        free(dense);
+        if (status != 0)
+            MPI_Abort(MPI_COMM_WORLD, 1);
+
+        row_len = (int*)malloc(n * sizeof(int));
+        for (int i = 0; i < n; i++)
+            row_len[i] = A.row_ptr[i + 1] - A.row_ptr[i];
+
+        nnz_counts = (int*)malloc(size * sizeof(int));
+        nnz_displs = (int*)malloc(size * sizeof(int));
+        for (int r = 0; r < size; r++) {
+            nnz_displs[r] = A.row_ptr[r * rows_per_proc];
+            nnz_counts[r] = A.row_ptr[(r + 1) * rows_per_proc] - nnz_displs[r];
+        }
+    }
+
+    // Start timing
+    double start_time = MPI_Wtime();
+
+    // Scatter row lengths, then each rank rebuilds its own row_ptr
+    csr_t local = {rows_per_proc, n, 0, NULL, NULL, NULL};
+    int* local_len = (int*)malloc(rows_per_proc * sizeof(int));
+    MPI_Scatter(row_len, rows_per_proc, MPI_INT,
+                local_len, rows_per_proc, MPI_INT, 0, MPI_COMM_WORLD);
+
+    local.row_ptr = (int*)malloc((rows_per_proc + 1) * sizeof(int));
+    local.row_ptr[0] = 0;
+    for (int i = 0; i < rows_per_proc; i++)
+        local.row_ptr[i + 1] = local.row_ptr[i] + local_len[i];
+    local.nnz = local.row_ptr[rows_per_proc];
+    free(local_len);
+
+    // Scatter the nonzeros of each row block
+    local.col_idx = (int*)malloc(local.nnz * sizeof(int));
+    local.val = (int*)malloc(local.nnz * sizeof(int));
+    MPI_Scatterv(A.col_idx, nnz_counts, nnz_displs, MPI_INT,
+                 local.col_idx, local.nnz, MPI_INT, 0, MPI_COMM_WORLD);
+    MPI_Scatterv(A.val, nnz_counts, nnz_displs, MPI_INT,
+                 local.val, local.nnz, MPI_INT, 0, MPI_COMM_WORLD);
+
+    // Scatter x with the same row distribution
+    int* local_x = (int*)malloc(rows_per_proc * sizeof(int));
+    MPI_Scatter(x, rows_per_proc, MPI_INT,
+                local_x, rows_per_proc, MPI_INT, 0, MPI_COMM_WORLD);
+
+    // ----------------------------
+    // Halo setup: find the remote x entries our rows touch
+    // ----------------------------
+    int* halo_slot = (int*)malloc(n * sizeof(int));
+    for (int j = 0; j < n; j++) halo_slot[j] = -1;
+
+    int* recv_counts = (int*)calloc(size, sizeof(int));
+    for (int p = 0; p < local.nnz; p++) {
+        int c = local.col_idx[p];
+        if ((c < lo || c >= hi) && halo_slot[c] == -1) {
+            halo_slot[c] = 0;
+            recv_counts[c / rows_per_proc]++;
+        }
+    }
+
+    int* recv_displs = (int*)malloc(size * sizeof(int));
+    int halo_size = 0;
+    for (int r = 0; r < size; r++) {
+        recv_displs[r] = halo_size;
+        halo_size += recv_counts[r];
+    }
+
+    // Needed indices grouped by owner, ascending, so slot order matches the
+    // order in which each owner will send the values
+    int* need = (int*)malloc((halo_size ? halo_size : 1) * sizeof(int));
+    int slot = 0;
+    for (int j = 0; j < n; j++) {
+        if (halo_slot[j] == 0) {
+            halo_slot[j] = rows_per_proc + slot;
+            need[slot++] = j;
+        }
+    }
+
+    // Tell every owner which of its entries we need
+    int* send_counts = (int*)malloc(size * sizeof(int));
+    MPI_Alltoall(recv_counts, 1, MPI_INT, send_counts, 1, MPI_INT, MPI_COMM_WORLD);
+
+    int* send_displs = (int*)malloc(size * sizeof(int));
+    int send_size = 0;
+    for (int r = 0; r < size; r++) {
+        send_displs[r] = send_size;
+        send_size += send_counts[r];
+    }
+
+    int* send_idx = (int*)malloc((send_size ? send_size : 1) * sizeof(int));
+    MPI_Alltoallv(need, recv_counts, recv_displs, MPI_INT,
+                  send_idx, send_counts, send_displs, MPI_INT, MPI_COMM_WORLD);
+
+    // Renumber columns into [own block | halo] so the kernel needs no lookups
+    for (int p = 0; p < local.nnz; p++) {
+        int c = local.col_idx[p];
+        local.col_idx[p] = (c >= lo && c < hi) ? c - lo : halo_slot[c];
+    }
+
+    int* x_ext = (int*)malloc((rows_per_proc + halo_size) * sizeof(int));
+    int* send_buf = (int*)malloc((send_size ? send_size : 1) * sizeof(int));
+    int* local_y = (int*)malloc(rows_per_proc * sizeof(int));
+    memcpy(x_ext, local_x, rows_per_proc * sizeof(int));
+
+    double setup_time = MPI_Wtime() - start_time;
+
+    // ----------------------------
+    // Halo exchange + local SpMV
+    // ----------------------------
+    for (int it = 0; it < ITERS; it++) {
+        for (int s = 0; s < send_size; s++)
+            send_buf[s] = local_x[send_idx[s] - lo];
+
+        MPI_Alltoallv(send_buf, send_counts, send_displs, MPI_INT,
+                      x_ext + rows_per_proc, recv_counts, recv_displs, MPI_INT, MPI_COMM_WORLD);
+
+        csrSpMV(&local, x_ext, local_y);
+    }
+
+    // Gather results
+    MPI_Gather(local_y, rows_per_proc, MPI_INT,
+               y, rows_per_proc, MPI_INT, 0, MPI_COMM_WORLD);
+
+    // End timing
+    double end_time = MPI_Wtime();
+    double elapsed = end_time - start_time;
+
+    int total_halo = 0;
+    MPI_Reduce(&halo_size, &total_halo, 1, MPI_INT, MPI_SUM, 0, MPI_COMM_WORLD);
+
+    if (rank == 0) {
+        int* check = (int*)malloc(n * sizeof(int));
+        csrSpMV(&A, x, check);
+        int errors = 0;
+        for (int i = 0; i < n; i++)
+            if (check[i] != y[i]) errors++;
+
+        printf("Distributed CSR SpMV Complete!\n");
+        printf("Matrix size: %dx%d, nnz: %d, Processes: %d\n", n, n, A.nnz, size);
+        printf("Halo entries exchanged per SpMV: %d\n", total_halo);
+        printf("Setup time: %f seconds\n", setup_time);
+        printf("Elapsed time (%d SpMVs): %f seconds\n", ITERS, elapsed);
+        printf("Verification: %s\n", errors ? "FAILED" : "passed");
+        free(check);
+    }
+
+    // Free memory
+    free(halo_slot);
+    free(need);
+    free(recv_counts);
+    free(recv_displs);
+    free(send_counts);
+    free(send_displs);
+    free(send_idx);
+    free(send_buf);
+    free(x_ext);
+    free(local_x);
+    free(local_y);
+    csrFree(&local);
+    if (rank == 0) {
+        csrFree(&A);
+        free(x);
+        free(y);
+        free(row_len);
+        free(nnz_counts);
+        free(nnz_displs);
+    }
+
+    MPI_Finalize();
+    return 0;
+}
@@ -0,0 +1,141 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <mpi.h>
+#include "../common/nqueens_bits.h"
+
+// Distributed N-Queens counting, master-worker. Build and run:
+//   mpicc -O3 -march=native nqueens.c -o nqueens
+//   mpirun -np 8 ./nqueens [N] [batch size]
+//
+// Every rank builds the same list of mirror-reduced prefixes, so work is
+// handed out as index ranges. Rank 0 only dispatches: a worker asks for
+// work, gets the next batch of prefixes, counts their subtrees with the
+// bitboard kernel and asks again. Subtree sizes vary a lot, so nothing is
+// assigned up front. Without a batch size the batches shrink as the list
+// runs down (half the remainder split over the workers), which keeps the
+// message count low early and the tail short at the end.
+
+#define DEFAULT_N 16
+#define TASKS_PER_WORKER 64   // prefixes per worker when choosing the depth
+#define TAG_REQUEST 1
+#define TAG_WORK 2
+
+// Known totals, for checking (OEIS A000170)
+static const long long known[] = {1, 1, 0, 0, 2, 10, 4, 40, 92, 352, 724, 2680, 14200, 73712,
+                                  365596, 2279184, 14772512, 95815104, 666090624, 4968057848LL,
+                                  39029188884LL, 314666222712LL};
+
+int main(int argc, char *argv[]) {
+    int rank, size;
+
+    MPI_Init(&argc, &argv);
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+    int n = (argc > 1) ? atoi(argv[1]) : DEFAULT_N;
+    int batch = (argc > 2) ? atoi(argv[2]) : 0;   // 0: shrinking batches
+    if (n < 1 || n > NQUEENS_MAX) {
+        if (rank == 0) fprintf(stderr, "N must be between 1 and %d\n", NQUEENS_MAX);
+        MPI_Finalize();
+        return 1;
+    }
+    int workers = (size > 1) ? size - 1 : 1;
+
+    MPI_Barrier(MPI_COMM_WORLD);
+    double start_time = MPI_Wtime();
+
+    nqueens_prefixes_t prefixes = {NULL, 0, 0, 0};
+    nqueensChoosePrefixes(&prefixes, n, 0, TASKS_PER_WORKER * workers, 1);
+
+    long long local = 0;
+    int batches = 0;
+    double busy = 0;
+
+    if (size == 1) {
+        // No one to hand work to
+        double t = MPI_Wtime();
+        for (int i = 0; i < prefixes.count; i++) {
+            const nqueens_prefix_t *p = &prefixes.items[i];
+            local += p->weight * nqueensCount(n, prefixes.depth, p->cols, p->ld, p->rd);
+        }
+        busy = MPI_Wtime() - t;
+        batches = 1;
+    } else if (rank == 0) {
+        // Master: answer requests until every worker has been told to stop
+        int next = 0, active = workers;
+        while (active > 0) {
+            int dummy;
+            MPI_Status status;
+            MPI_Recv(&dummy, 1, MPI_INT, MPI_ANY_SOURCE, TAG_REQUEST, MPI_COMM_WORLD, &status);
+
+            int remaining = prefixes.count - next;
+            int take = (batch > 0) ? batch : remaining / (2 * workers);
+            if (take < 1) take = 1;
+            if (take > remaining) take = remaining;
+
+            int range[2] = {next, take};   // take == 0 means stop
+            MPI_Send(range, 2, MPI_INT, status.MPI_SOURCE, TAG_WORK, MPI_COMM_WORLD);
+            next += take;
+            if (take == 0)
+                active--;
+            else
+                batches++;
+        }
+    } else {
+        // Worker: ask, count, repeat
+        while (1) {
+            int dummy = 0, range[2];
+            MPI_Send(&dummy, 1, MPI_INT, 0, TAG_REQUEST, MPI_COMM_WORLD);
+            MPI_Recv(range, 2, MPI_INT, 0, TAG_WORK, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+            if (range[1] == 0)
+                break;
+
+            double t = MPI_Wtime();
+            for (int i = range[0]; i < range[0] + range[1]; i++) {
+                const nqueens_prefix_t *p = &prefixes.items[i];
+                local += p->weight * nqueensCount(n, prefixes.depth, p->cols, p->ld, p->rd);
+            }
+            busy += MPI_Wtime() - t;
+            batches++;
+        }
+    }
+
+    long long total = 0;
+    MPI_Reduce(&local, &total, 1, MPI_LONG_LONG, MPI_SUM, 0, MPI_COMM_WORLD);
+
+    double end_time = MPI_Wtime();
+
+    // Per-rank load: batches taken and time spent counting
+    int *all_batches = NULL;
+    double *all_busy = NULL;
+    if (rank == 0) {
+        all_batches = (int *)malloc(size * sizeof(int));
+        all_busy = (double *)malloc(size * sizeof(double));
+    }
+    MPI_Gather(&batches, 1, MPI_INT, all_batches, 1, MPI_INT, 0, MPI_COMM_WORLD);
+    MPI_Gather(&busy, 1, MPI_DOUBLE, all_busy, 1, MPI_DOUBLE, 0, MPI_COMM_WORLD);
+
+    if (rank == 0) {
+        printf("Distributed N-Queens Complete!\n");
+        printf("N: %d, Processes: %d (%d workers), prefix depth: %d, prefixes: %d\n",
+               n, size, workers, prefixes.depth, prefixes.count);
+        printf("Total solutions: %lld\n", total);
+        printf("Elapsed time: %f seconds\n", end_time - start_time);
+        if (size == 1) {
+            printf("Rank 0 counted everything in %f s\n", all_busy[0]);
+        } else {
+            printf("Master handed out %d batches\n", all_batches[0]);
+            for (int r = 1; r < size; r++)
+                printf("  worker %d: %d batches, %f s counting\n", r, all_batches[r], all_busy[r]);
+        }
+        if (n < (int)(sizeof(known) / sizeof(known[0])))
+            printf("Verification: %s\n", total == known[n] ? "passed" : "FAILED");
+        free(all_batches);
+        free(all_busy);
+    }
+
+    free(prefixes.items);
+
+    MPI_Finalize();
+    return 0;
+}
@@ -0,0 +1,243 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <unistd.h>
+#include <mpi.h>
+#include "../A3_2/p_merge.h"
+
+// Distributed sample sort. Build and run:
+//   mpicc -O3 -march=native sampleSort.c ../A3_2/p_radix.c -lpthread -o sampleSort
+//   mpirun -np 8 ./sampleSort [keys per rank] [uniform|skewed|constant]
+
+#define LOCAL_N (1 << 22)     // keys per rank unless given on the command line
+#define SAMPLES_PER_RANK 256
+
+// Keys are ordered by (value, rank, local index), which makes every key
+// distinct. Splitters picked that way cut runs of equal values wherever
+// needed, so skewed or constant inputs still split evenly.
+typedef struct {
+    int key;
+    int rank;
+    long idx;
+} sample_t;
+
+int sample_cmp(const void *a, const void *b) {
+    const sample_t *x = (const sample_t *)a, *y = (const sample_t *)b;
+    if (x->key != y->key) return x->key < y->key ? -1 : 1;
+    if (x->rank != y->rank) return x->rank < y->rank ? -1 : 1;
+    return (x->idx > y->idx) - (x->idx < y->idx);
+}
+
+// Local keys that order before splitter s in (value, rank, index) order
+long count_before(const int *a, long n, int rank, const sample_t *s) {
+    long lo = 0, hi = n;
+    while (lo < hi) {  // first key >= s->key
+        long mid = lo + (hi - lo) / 2;
+        if (a[mid] < s->key) lo = mid + 1; else hi = mid;
+    }
+    if (rank < s->rank) {  // all our copies of s->key come first
+        hi = n;
+        while (lo < hi) {
+            long mid = lo + (hi - lo) / 2;
+            if (a[mid] <= s->key) lo = mid + 1; else hi = mid;
+        }
+    } else if (rank == s->rank) {
+        lo = s->idx;
+    }
+    return lo;
+}
+
+// Merge the k sorted runs in[displs[r] .. displs[r] + counts[r]) into out
+// with a binary heap of run heads; k is the number of ranks
+void kway_merge(const int *in, const int *displs, const int *counts, int k, int *out) {
+    int *heap = (int *)malloc(k * sizeof(int));   // run ids, min head on top
+    long *pos = (long *)malloc(k * sizeof(long));
+    int size = 0;
+
+    for (int r = 0; r < k; r++) {
+        pos[r] = displs[r];
+        if (counts[r] == 0) continue;
+        int i = size++;
+        while (i > 0 && in[pos[heap[(i - 1) / 2]]] > in[pos[r]]) {
+            heap[i] = heap[(i - 1) / 2];
+            i = (i - 1) / 2;
+        }
+        heap[i] = r;
+    }
+
+    long o = 0;
+    while (size > 0) {
+        int r = heap[0];
+        out[o++] = in[pos[r]++];
+        if (pos[r] == (long)displs[r] + counts[r])
+            r = heap[--size];
+        if (size == 0) break;
+
+        // sift r down from the root
+        int i = 0;
+        while (1) {
+            int c = 2 * i + 1;
+            if (c >= size) break;
+            if (c + 1 < size && in[pos[heap[c + 1]]] < in[pos[heap[c]]]) c++;
+            if (in[pos[heap[c]]] >= in[pos[r]]) break;
+            heap[i] = heap[c];
+            i = c;
+        }
+        heap[i] = r;
+    }
+
+    free(heap);
+    free(pos);
+}
+
+int main(int argc, char *argv[]) {
+    int rank, size;
+
+    MPI_Init(&argc, &argv);
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+    long n = (argc > 1) ? atol(argv[1]) : LOCAL_N;
+    const char *dist = (argc > 2) ? argv[2] : "uniform";
+
+    // Split this host's cores between the ranks running on it
+    MPI_Comm node;
+    int node_ranks;
+    MPI_Comm_split_type(MPI_COMM_WORLD, MPI_COMM_TYPE_SHARED, rank, MPI_INFO_NULL, &node);
+    MPI_Comm_size(node, &node_ranks);
+    MPI_Comm_free(&node);
+    int threads = (int)sysconf(_SC_NPROCESSORS_ONLN) / node_ranks;
+    if (threads < 1) threads = 1;
+
+    // Every rank generates its own share; nothing is ever held in one place
+    int *local = (int *)malloc(n * sizeof(int));
+    srand(12345 + rank);
+    for (long i = 0; i < n; i++) {
+        if (strcmp(dist, "constant") == 0)
+            local[i] = 42;
+        else if (strcmp(dist, "skewed") == 0)   // 3/4 of keys in [0, 16)
+            local[i] = (rand() % 4) ? rand() % 16 : rand();
+        else
+            local[i] = rand();
+    }
+    long long checksum = 0;
+    for (long i = 0; i < n; i++) checksum += local[i];
+
+    MPI_Barrier(MPI_COMM_WORLD);
+    double start_time = MPI_Wtime();
+
+    // Step 1: Sort locally with the shared-memory radix sort
+    radix_sort_p(local, 0, (int)n - 1, threads);
+    double sort_time = MPI_Wtime();
+
+    // Step 2: Regular samples of the sorted data, gathered everywhere;
+    // every rank sorts the same samples and picks the same splitters
+    sample_t mine[SAMPLES_PER_RANK];
+    for (int s = 0; s < SAMPLES_PER_RANK; s++) {
+        long idx = n * s / SAMPLES_PER_RANK;
+        mine[s].key = n ? local[idx] : INT_MAX;
+        mine[s].rank = n ? rank : size;
+        mine[s].idx = idx;
+    }
+    sample_t *all = (sample_t *)malloc((long)size * SAMPLES_PER_RANK * sizeof(sample_t));
+    MPI_Allgather(mine, SAMPLES_PER_RANK * sizeof(sample_t), MPI_BYTE,
+                  all, SAMPLES_PER_RANK * sizeof(sample_t), MPI_BYTE, MPI_COMM_WORLD);
+    qsort(all, (long)size * SAMPLES_PER_RANK, sizeof(sample_t), sample_cmp);
+
+    // Step 3: Cut the local array at the splitters and exchange buckets
+    int *send_counts = (int *)malloc(size * sizeof(int));
+    int *send_displs = (int *)malloc(size * sizeof(int));
+    int *recv_counts = (int *)malloc(size * sizeof(int));
+    int *recv_displs = (int *)malloc(size * sizeof(int));
+    long prev = 0;
+    for (int r = 0; r < size; r++) {
+        long cut = (r == size - 1) ? n
+                 : count_before(local, n, rank, &all[(long)(r + 1) * SAMPLES_PER_RANK]);
+        send_counts[r] = (int)(cut - prev);
+        send_displs[r] = (int)prev;
+        prev = cut;
+    }
+    free(all);
+
+    MPI_Alltoall(send_counts, 1, MPI_INT, recv_counts, 1, MPI_INT, MPI_COMM_WORLD);
+    long recv_total = 0;
+    for (int r = 0; r < size; r++) {
+        recv_displs[r] = (int)recv_total;
+        recv_total += recv_counts[r];
+    }
+
+    int *received = (int *)malloc((recv_total ? recv_total : 1) * sizeof(int));
+    MPI_Alltoallv(local, send_counts, send_displs, MPI_INT,
+                  received, recv_counts, recv_displs, MPI_INT, MPI_COMM_WORLD);
+    free(local);
+    double exchange_time = MPI_Wtime();
+
+    // Step 4: The size buckets we received are each sorted; merge them
+    int *sorted = (int *)malloc((recv_total ? recv_total : 1) * sizeof(int));
+    kway_merge(received, recv_displs, recv_counts, size, sorted);
+    free(received);
+
+    MPI_Barrier(MPI_COMM_WORLD);
+    double end_time = MPI_Wtime();
+
+    // Verification: sorted locally, ordered across rank boundaries, and
+    // the same multiset of keys (count and sum) as before
+    int errors = 0;
+    for (long i = 1; i < recv_total; i++)
+        if (sorted[i - 1] > sorted[i]) errors++;
+
+    int edge[2] = {recv_total ? sorted[0] : 0, recv_total ? sorted[recv_total - 1] : 0};
+    int has = recv_total > 0;
+    int *edges = NULL, *have = NULL;
+    if (rank == 0) {
+        edges = (int *)malloc(2 * size * sizeof(int));
+        have = (int *)malloc(size * sizeof(int));
+    }
+    MPI_Gather(edge, 2, MPI_INT, edges, 2, MPI_INT, 0, MPI_COMM_WORLD);
+    MPI_Gather(&has, 1, MPI_INT, have, 1, MPI_INT, 0, MPI_COMM_WORLD);
+
+    long long sorted_sum = 0;
+    for (long i = 0; i < recv_total; i++) sorted_sum += sorted[i];
+    long long sums[2] = {checksum, sorted_sum}, total_sums[2];
+    long counts[2] = {n, recv_total}, total_counts[2];
+    long max_count, min_count;
+    int total_errors;
+    MPI_Reduce(sums, total_sums, 2, MPI_LONG_LONG, MPI_SUM, 0, MPI_COMM_WORLD);
+    MPI_Reduce(counts, total_counts, 2, MPI_LONG, MPI_SUM, 0, MPI_COMM_WORLD);
+    MPI_Reduce(&recv_total, &max_count, 1, MPI_LONG, MPI_MAX, 0, MPI_COMM_WORLD);
+    MPI_Reduce(&recv_total, &min_count, 1, MPI_LONG, MPI_MIN, 0, MPI_COMM_WORLD);
+    MPI_Reduce(&errors, &total_errors, 1, MPI_INT, MPI_SUM, 0, MPI_COMM_WORLD);
+
+    if (rank == 0) {
+        int last = -1;
+        for (int r = 0; r < size; r++) {
+            if (!have[r]) continue;
+            if (last >= 0 && edges[2 * last + 1] > edges[2 * r]) total_errors++;
+            last = r;
+        }
+        if (total_sums[0] != total_sums[1] || total_counts[0] != total_counts[1])
+            total_errors++;
+
+        printf("Distributed Sample Sort Complete!\n");
+        printf("Keys: %ld (%ld per rank, %s), Processes: %d, threads per rank: %d\n",
+               total_counts[0], n, dist, size, threads);
+        printf("Local sort: %f s, splitters + exchange: %f s, merge: %f s\n",
+               sort_time - start_time, exchange_time - sort_time, end_time - exchange_time);
+        printf("Elapsed time: %f seconds\n", end_time - start_time);
+        printf("Keys per rank after exchange: min %ld, max %ld (ideal %ld)\n",
+               min_count, max_count, n);
+        printf("Verification: %s\n", total_errors ? "FAILED" : "passed");
+        free(edges);
+        free(have);
+    }
+
+    free(sorted);
+    free(send_counts);
+    free(send_displs);
+    free(recv_counts);
+    free(recv_displs);
+
+    MPI_Finalize();
+    return 0;
+}
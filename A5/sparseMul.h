@@ -0,0 +1,78 @@
+#ifndef SPARSEMUL_H
+#define SPARSEMUL_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <mpi.h>
+
+// Compressed Sparse Row: the nonzeros of row i are val[row_ptr[i] .. row_ptr[i+1]-1]
+// with their column numbers in col_idx
+typedef struct {
+    int rows, cols;
+    int nnz;
+    int* row_ptr;   // rows + 1 entries
+    int* col_idx;   // nnz entries
+    int* val;       // nnz entries
+} csr_t;
+
+void csrFree(csr_t* A)
+{
+    free(A->row_ptr);
+    free(A->col_idx);
+    free(A->val);
+    A->row_ptr = A->col_idx = A->val = NULL;
+}
+
+// Build CSR from a flat row-major rows x cols matrix into *out;
+// returns -1 (with *out left empty) if an allocation fails
+int csrFromFlat(const int* M, int rows, int cols, csr_t* out)
+{
+    csr_t A = {rows, cols, 0, NULL, NULL, NULL};
+    *out = A;
+    A.row_ptr = (int*)malloc((rows + 1) * sizeof(int));
+    if (A.row_ptr == NULL) {
+        printf("Memory allocation failed!\n");
+        return -1;
+    }
+
+    A.row_ptr[0] = 0;
+    for (int i = 0; i < rows; i++) {
+        int count = 0;
+        for (int j = 0; j < cols; j++)
+            if (M[i * cols + j] != 0) count++;
+        A.row_ptr[i + 1] = A.row_ptr[i] + count;
+    }
+    A.nnz = A.row_ptr[rows];
+
+    A.col_idx = (int*)malloc(A.nnz * sizeof(int));
+    A.val = (int*)malloc(A.nnz * sizeof(int));
+    if ((A.col_idx == NULL || A.val == NULL) && A.nnz > 0) {
+        printf("Memory allocation failed!\n");
+        csrFree(&A);
+        return -1;
+    }
+
+    int p = 0;
+    for (int i = 0; i < rows; i++)
+        for (int j = 0; j < cols; j++)
+            if (M[i * cols + j] != 0) {
+                A.col_idx[p] = j;
+                A.val[p] = M[i * cols + j];
+                p++;
+            }
+    *out = A;
+    return 0;
+}
+
+// y = A * x, where col_idx already indexes into x
+void csrSpMV(const csr_t* A, const int* x, int* y)
+{
+    for (int i = 0; i < A->rows; i++) {
+        int sum = 0;
+        for (int p = A->row_ptr[i]; p < A->row_ptr[i + 1]; p++)
+            sum += A->val[p] * x[A->col_idx[p]];
+        y[i] = sum;
+    }
+}
+
+#endif
@@ -0,0 +1,253 @@
+#ifndef GEMM_TUNE_H
+#define GEMM_TUNE_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#define CL_TARGET_OPENCL_VERSION 300
+#include <CL/cl.h>
+
+#define TUNE_CACHE "gemm_tuning.txt"  // best config per device, one per line
+#define TUNE_REPS 3                   // timed runs per candidate
+#define TUNE_SAMPLES 64               // entries spot-checked per candidate
+#define PAD 64                        // matrices padded to a multiple of the largest tile
+
+// Kernel parameters, passed to the compiler as -D options:
+//   TS  - each work-group computes a TS x TS tile of C
+//   WPT - rows of C per work-item (register blocking)
+//   VW  - columns of C per work-item, loaded and stored as intVW vectors
+// Work-group shape is (TS/VW, TS/WPT). Matrices are zero padded to a
+// multiple of TS on the host, so any N works and the kernel needs no
+// bounds checks.
+typedef struct {
+    int ts, wpt, vw;
+} gemm_config_t;
+
+static const char* gemmKernelSource =
+    "#define CAT_(a, b) a##b\n"
+    "#define CAT(a, b) CAT_(a, b)\n"
+    "#if VW == 1\n"
+    "typedef int intv;\n"
+    "#define VLOAD(p) (*(p))\n"
+    "#define VSTORE(v, p) (*(p) = (v))\n"
+    "#else\n"
+    "typedef CAT(int, VW) intv;\n"
+    "#define VLOAD(p) CAT(vload, VW)(0, p)\n"
+    "#define VSTORE(v, p) CAT(vstore, VW)(v, 0, p)\n"
+    "#endif\n"
+    "#define RTS (TS / WPT)\n"
+    "__kernel __attribute__((reqd_work_group_size(TS / VW, TS / WPT, 1)))\n"
+    "void matMulTuned(__global const int* A, __global const int* B, __global int* C, int Np) {\n"
+    "    __local int Asub[TS][TS];\n"
+    "    __local int Bsub[TS][TS];\n"
+    "    int lx = get_local_id(0);\n"
+    "    int ly = get_local_id(1);\n"
+    "    int rowBase = get_group_id(1) * TS;\n"
+    "    int col = get_group_id(0) * TS + lx * VW;\n"
+    "    intv acc[WPT];\n"
+    "    for (int w = 0; w < WPT; w++) acc[w] = 0;\n"
+    "    for (int t = 0; t < Np / TS; t++) {\n"
+    "        for (int w = 0; w < WPT; w++) {\n"
+    "            int r = ly + w * RTS;\n"
+    "            VSTORE(VLOAD(&A[(rowBase + r) * Np + t * TS + lx * VW]), &Asub[r][lx * VW]);\n"
+    "            VSTORE(VLOAD(&B[(t * TS + r) * Np + col]), &Bsub[r][lx * VW]);\n"
+    "        }\n"
+    "        barrier(CLK_LOCAL_MEM_FENCE);\n"
+    "        for (int k = 0; k < TS; k++) {\n"
+    "            intv b = VLOAD(&Bsub[k][lx * VW]);\n"
+    "            for (int w = 0; w < WPT; w++)\n"
+    "                acc[w] += Asub[ly + w * RTS][k] * b;\n"
+    "        }\n"
+    "        barrier(CLK_LOCAL_MEM_FENCE);\n"
+    "    }\n"
+    "    for (int w = 0; w < WPT; w++)\n"
+    "        VSTORE(acc[w], &C[(rowBase + ly + w * RTS) * Np + col]);\n"
+    "}\n";
+
+int padSize(int n)
+{
+    return (n + PAD - 1) / PAD * PAD;
+}
+
+// Build matMulTuned for one config; returns NULL (and prints the log when
+// verbose) if the device rejects it
+cl_kernel buildGemmKernel(cl_context context, cl_device_id device, gemm_config_t cfg,
+                          cl_program* programOut, int verbose)
+{
+    cl_int status;
+    char options[128];
+    snprintf(options, sizeof(options), "-DTS=%d -DWPT=%d -DVW=%d", cfg.ts, cfg.wpt, cfg.vw);
+
+    cl_program program = clCreateProgramWithSource(context, 1, &gemmKernelSource, NULL, &status);
+    if (status != CL_SUCCESS) return NULL;
+
+    status = clBuildProgram(program, 1, &device, options, NULL, NULL);
+    if (status != CL_SUCCESS) {
+        if (verbose) {
+            size_t size;
+            clGetProgramBuildInfo(program, device, CL_PROGRAM_BUILD_LOG, 0, NULL, &size);
+            char* log = malloc(size);
+            clGetProgramBuildInfo(program, device, CL_PROGRAM_BUILD_LOG, size, log, NULL);
+            printf("BUILD LOG (%s):\n%s\n", options, log);
+            free(log);
+        }
+        clReleaseProgram(program);
+        return NULL;
+    }
+
+    cl_kernel kernel = clCreateKernel(program, "matMulTuned", &status);
+    if (status != CL_SUCCESS) {
+        clReleaseProgram(program);
+        return NULL;
+    }
+    *programOut = program;
+    return kernel;
+}
+
+// Enqueue one C = A * B on padded Np x Np buffers and wait for it
+cl_int runGemmKernel(cl_command_queue queue, cl_kernel kernel, gemm_config_t cfg,
+                     cl_mem bufA, cl_mem bufB, cl_mem bufC, int Np)
+{
+    clSetKernelArg(kernel, 0, sizeof(cl_mem), &bufA);
+    clSetKernelArg(kernel, 1, sizeof(cl_mem), &bufB);
+    clSetKernelArg(kernel, 2, sizeof(cl_mem), &bufC);
+    clSetKernelArg(kernel, 3, sizeof(int), &Np);
+
+    size_t local[2]  = {cfg.ts / cfg.vw, cfg.ts / cfg.wpt};
+    size_t global[2] = {Np / cfg.vw, Np / cfg.wpt};
+
+    cl_int status = clEnqueueNDRangeKernel(queue, kernel, 2, NULL, global, local, 0, NULL, NULL);
+    if (status == CL_SUCCESS)
+        status = clFinish(queue);
+    return status;
+}
+
+// ----------------------------
+// Tuning cache: "<device name>\t<ts> <wpt> <vw>" per line
+// ----------------------------
+int loadTunedConfig(const char* deviceName, gemm_config_t* cfg)
+{
+    FILE* f = fopen(TUNE_CACHE, "r");
+    if (!f) return 0;
+
+    char line[512];
+    int found = 0;
+    while (fgets(line, sizeof(line), f)) {
+        char* tab = strchr(line, '\t');
+        if (!tab) continue;
+        *tab = '\0';
+        if (strcmp(line, deviceName) == 0 &&
+            sscanf(tab + 1, "%d %d %d", &cfg->ts, &cfg->wpt, &cfg->vw) == 3) {
+            found = 1;  // keep scanning: the newest entry wins
+        }
+    }
+    fclose(f);
+    return found;
+}
+
+void saveTunedConfig(const char* deviceName, gemm_config_t cfg)
+{
+    FILE* f = fopen(TUNE_CACHE, "a");
+    if (!f) {
+        perror("fopen " TUNE_CACHE);
+        return;
+    }
+    fprintf(f, "%s\t%d %d %d\n", deviceName, cfg.ts, cfg.wpt, cfg.vw);
+    fclose(f);
+}
+
+// Compare TUNE_SAMPLES pseudo-random entries of the padded result against
+// a CPU dot product; the full check stays in main
+static int spotCheck(const int* flatA, const int* flatB, const int* flatC, int n, int Np)
+{
+    unsigned seed = 12345;
+    for (int s = 0; s < TUNE_SAMPLES; s++) {
+        seed = seed * 1103515245u + 12345u;
+        int i = (seed >> 8) % n;
+        seed = seed * 1103515245u + 12345u;
+        int j = (seed >> 8) % n;
+        int sum = 0;
+        for (int k = 0; k < n; k++)
+            sum += flatA[i * Np + k] * flatB[k * Np + j];
+        if (sum != flatC[i * Np + j]) return 0;
+    }
+    return 1;
+}
+
+// Try every config the device can hold on the real problem and store the
+// fastest one that gives correct results in *best. Returns 0, leaving the
+// plain TS=16 WPT=1 VW=1 config in *best, if no candidate built, ran and
+// passed the spot check; that config is then untested and must not be
+// cached.
+int tuneGemm(cl_context context, cl_device_id device, cl_command_queue queue,
+             cl_mem bufA, cl_mem bufB, cl_mem bufC,
+             const int* flatA, const int* flatB, int n, int Np, gemm_config_t* best)
+{
+    static const int tileSizes[] = {8, 16, 32, 64};
+    static const int wpts[] = {1, 2, 4, 8};
+    static const int vws[] = {1, 2, 4, 8};
+
+    size_t maxWG, maxItem[3];
+    cl_ulong localMem;
+    clGetDeviceInfo(device, CL_DEVICE_MAX_WORK_GROUP_SIZE, sizeof(maxWG), &maxWG, NULL);
+    clGetDeviceInfo(device, CL_DEVICE_MAX_WORK_ITEM_SIZES, sizeof(maxItem), maxItem, NULL);
+    clGetDeviceInfo(device, CL_DEVICE_LOCAL_MEM_SIZE, sizeof(localMem), &localMem, NULL);
+
+    gemm_config_t plain = {16, 1, 1};
+    *best = plain;
+    double bestTime = -1.0;
+
+    int* flatC = (int*)malloc((size_t)Np * Np * sizeof(int));
+    if (!flatC) {
+        printf("Memory allocation failed!\n");
+        return 0;
+    }
+
+    for (int a = 0; a < 4; a++)
+    for (int b = 0; b < 4; b++)
+    for (int c = 0; c < 4; c++) {
+        gemm_config_t cfg = {tileSizes[a], wpts[b], vws[c]};
+        size_t lx = cfg.ts / cfg.vw, ly = cfg.ts / cfg.wpt;
+
+        if (cfg.wpt > cfg.ts || cfg.vw > cfg.ts) continue;
+        if (lx * ly > maxWG || lx > maxItem[0] || ly > maxItem[1]) continue;
+        if (2 * (cl_ulong)cfg.ts * cfg.ts * sizeof(int) > localMem) continue;
+        if (lx * ly < 16) continue;  // too little parallelism to be worth timing
+
+        cl_program program;
+        cl_kernel kernel = buildGemmKernel(context, device, cfg, &program, 0);
+        if (!kernel) continue;
+
+        // warm-up run also catches launch failures
+        if (runGemmKernel(queue, kernel, cfg, bufA, bufB, bufC, Np) != CL_SUCCESS) {
+            clReleaseKernel(kernel);
+            clReleaseProgram(program);
+            continue;
+        }
+
+        struct timeval t1, t2;
+        gettimeofday(&t1, NULL);
+        for (int r = 0; r < TUNE_REPS; r++)
+            runGemmKernel(queue, kernel, cfg, bufA, bufB, bufC, Np);
+        gettimeofday(&t2, NULL);
+        double t = ((t2.tv_sec - t1.tv_sec) + (t2.tv_usec - t1.tv_usec) / 1e6) / TUNE_REPS;
+
+        clEnqueueReadBuffer(queue, bufC, CL_TRUE, 0, (size_t)Np * Np * sizeof(int), flatC, 0, NULL, NULL);
+        int ok = spotCheck(flatA, flatB, flatC, n, Np);
+
+        printf("  TS=%2d WPT=%d VW=%d: %.4f sec%s\n", cfg.ts, cfg.wpt, cfg.vw, t, ok ? "" : " (wrong result, skipped)");
+        if (ok && (bestTime < 0 || t < bestTime)) {
+            bestTime = t;
+            *best = cfg;
+        }
+
+        clReleaseKernel(kernel);
+        clReleaseProgram(program);
+    }
+
+    free(flatC);
+    return bestTime >= 0;
+}
+
+#endif
@@ -3,11 +3,11 @@
 #include <stdlib.h>
 #include <time.h>
 #include <sys/time.h>
-#define CL_TARGET_OPENCL_VERSION 300
-#include <CL/cl.h>
+#include "gemmTune.h"
+#include "../common/freivalds.h"
 
-#define TILE 16        // tile size (best for Intel iGPU)
-#define N 1024         // matrix size
+#define N 1024         // matrix size (any size; padded to a multiple of PAD)
+#define CPU_BASELINE 1 // 0 skips the O(N^3) CPU timing run
 
 // Sequential CPU multiplication
 void matrixMultiplyCPU(int** A, int** B, int** C, int n) {
@@ -61,6 +61,7 @@ int main() {
 
     printf("Matrices initialized.\n");
 
+#if CPU_BASELINE
     // ----------------------------
     // CPU multiplication
     // ----------------------------
@@ -69,6 +70,7 @@ int main() {
     clock_t end_cpu = clock();
     double cpu_time = ((double)(end_cpu - start_cpu)) / CLOCKS_PER_SEC;
     printf("CPU multiplication time: %.4f sec\n", cpu_time);
+#endif
 
     // ----------------------------
     // OpenCL setup
@@ -79,10 +81,17 @@ int main() {
     status = clGetPlatformIDs(1, &platform, NULL);
     CHECK_ERROR(status, "clGetPlatformIDs");
 
+    // Prefer a GPU, but fall back to any device (e.g. a CPU runtime like PoCL)
     cl_device_id device;
     status = clGetDeviceIDs(platform, CL_DEVICE_TYPE_GPU, 1, &device, NULL);
+    if (status != CL_SUCCESS)
+        status = clGetDeviceIDs(platform, CL_DEVICE_TYPE_ALL, 1, &device, NULL);
     CHECK_ERROR(status, "clGetDeviceIDs");
 
+    char deviceName[256];
+    clGetDeviceInfo(device, CL_DEVICE_NAME, sizeof(deviceName), deviceName, NULL);
+    printf("Device: %s\n", deviceName);
+
     cl_context context = clCreateContext(NULL, 1, &device, NULL, NULL, &status);
     CHECK_ERROR(status, "clCreateContext");
 
@@ -90,84 +99,62 @@ int main() {
     CHECK_ERROR(status, "clCreateCommandQueueWithProperties");
 
     // ----------------------------
-    // Flatten matrices
+    // Flatten matrices, zero padded to Np x Np
     // ----------------------------
-    int* flatA = (int*)malloc(N*N*sizeof(int));
-    int* flatB = (int*)malloc(N*N*sizeof(int));
-    int* flatC = (int*)malloc(N*N*sizeof(int));
+    int Np = padSize(N);
+    int* flatA = (int*)calloc((size_t)Np*Np, sizeof(int));
+    int* flatB = (int*)calloc((size_t)Np*Np, sizeof(int));
+    int* flatC = (int*)calloc((size_t)Np*Np, sizeof(int));
 
     for (i = 0; i < N; i++)
         for (j = 0; j < N; j++) {
-            flatA[i*N + j] = A[i][j];
-            flatB[i*N + j] = B[i][j];
-            flatC[i*N + j] = 0;
+            flatA[i*Np + j] = A[i][j];
+            flatB[i*Np + j] = B[i][j];
         }
 
     // ----------------------------
     // Create OpenCL buffers
     // ----------------------------
     cl_mem bufA = clCreateBuffer(context, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR,
-                                 N*N*sizeof(int), flatA, &status);
+                                 (size_t)Np*Np*sizeof(int), flatA, &status);
     CHECK_ERROR(status, "clCreateBuffer A");
 
     cl_mem bufB = clCreateBuffer(context, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR,
-                                 N*N*sizeof(int), flatB, &status);
+                                 (size_t)Np*Np*sizeof(int), flatB, &status);
     CHECK_ERROR(status, "clCreateBuffer B");
 
     cl_mem bufC = clCreateBuffer(context, CL_MEM_WRITE_ONLY,
-                                 N*N*sizeof(int), NULL, &status);
+                                 (size_t)Np*Np*sizeof(int), NULL, &status);
     CHECK_ERROR(status, "clCreateBuffer C");
 
     // ----------------------------
-    // Optimized tiled OpenCL kernel for my outdated GPU
-    // ----------------------------
-    const char* kernelSource =
-        "__kernel void matMulTiled(__global int* A, __global int* B, __global int* C, int N) {"
-        "    __local int tileA[16][16];"
-        "    __local int tileB[16][16];"
-        "    int row = get_global_id(0);"
-        "    int col = get_global_id(1);"
-        "    int lr = get_local_id(0);"
-        "    int lc = get_local_id(1);"
-        "    int sum = 0;"
-        "    for (int t = 0; t < N/16; t++) {"
-        "        tileA[lr][lc] = A[row*N + (t*16 + lc)];"
-        "        tileB[lr][lc] = B[(t*16 + lr)*N + col];"
-        "        barrier(CLK_LOCAL_MEM_FENCE);"
-        "        for (int k = 0; k < 16; k++)"
-        "            sum += tileA[lr][k] * tileB[k][lc];"
-        "        barrier(CLK_LOCAL_MEM_FENCE);"
-        "    }"
-        "    C[row*N + col] = sum;"
-        "}";
-
-    cl_program program = clCreateProgramWithSource(context, 1, &kernelSource, NULL, &status);
-    CHECK_ERROR(status, "clCreateProgramWithSource");
-
-    status = clBuildProgram(program, 1, &device, NULL, NULL, NULL);
-    if (status != CL_SUCCESS) {
-        size_t size;
-        clGetProgramBuildInfo(program, device, CL_PROGRAM_BUILD_LOG, 0, NULL, &size);
-        char* log = malloc(size);
-        clGetProgramBuildInfo(program, device, CL_PROGRAM_BUILD_LOG, size, log, NULL);
-        printf("BUILD LOG:\n%s\n", log);
-        exit(1);
+    // Pick the kernel config: cached for this device, or tuned now
+    // ----------------------------
+    gemm_config_t cfg;
+    int cached = loadTunedConfig(deviceName, &cfg);
+    if (cached) {
+        printf("Using cached config TS=%d WPT=%d VW=%d\n", cfg.ts, cfg.wpt, cfg.vw);
+    } else {
+        printf("No cached config for this device, tuning...\n");
+        if (tuneGemm(context, device, queue, bufA, bufB, bufC, flatA, flatB, N, Np, &cfg)) {
+            saveTunedConfig(deviceName, cfg);
+            printf("Best config TS=%d WPT=%d VW=%d saved to %s\n", cfg.ts, cfg.wpt, cfg.vw, TUNE_CACHE);
+        } else {
+            // Nothing verified, so nothing is cached and the next run tunes again
+            printf("No config passed tuning; using plain TS=%d WPT=%d VW=%d (not cached)\n",
+                   cfg.ts, cfg.wpt, cfg.vw);
+        }
     }
 
-    cl_kernel kernel = clCreateKernel(program, "matMulTiled", &status);
-    CHECK_ERROR(status, "clCreateKernel");
-
-    // Kernel args
-    int n = N;
-
-    clSetKernelArg(kernel, 0, sizeof(cl_mem), &bufA);
-    clSetKernelArg(kernel, 1, sizeof(cl_mem), &bufB);
-    clSetKernelArg(kernel, 2, sizeof(cl_mem), &bufC);
-    clSetKernelArg(kernel, 3, sizeof(int), &n);
-
-    // Global/local sizes
-    size_t local[2]  = {TILE, TILE};
-    size_t global[2] = {N, N};
+    cl_program program;
+    cl_kernel kernel = buildGemmKernel(context, device, cfg, &program, 1);
+    if (!kernel) {
+        if (cached)
+            printf("Kernel build failed for cached config; delete %s to retune\n", TUNE_CACHE);
+        else
+            printf("Kernel build failed for config TS=%d WPT=%d VW=%d\n", cfg.ts, cfg.wpt, cfg.vw);
+        exit(1);
+    }
 
     // ----------------------------
     // Run GPU kernel
@@ -175,11 +162,9 @@ int main() {
     struct timeval t1, t2;
     gettimeofday(&t1, NULL);
 
-    status = clEnqueueNDRangeKernel(queue, kernel, 2, NULL, global, local, 0, NULL, NULL);
+    status = runGemmKernel(queue, kernel, cfg, bufA, bufB, bufC, Np);
     CHECK_ERROR(status, "clEnqueueNDRangeKernel");
 
-    clFinish(queue);
-
     gettimeofday(&t2, NULL);
     double gpu_time = (t2.tv_sec - t1.tv_sec) + (t2.tv_usec - t1.tv_usec)/1e6;
     printf("GPU multiplication time: %.4f sec\n", gpu_time);
@@ -187,18 +172,16 @@ int main() {
     // ----------------------------
     // Read back results
     // ----------------------------
-    clEnqueueReadBuffer(queue, bufC, CL_TRUE, 0, N*N*sizeof(int), flatC, 0, NULL, NULL);
+    clEnqueueReadBuffer(queue, bufC, CL_TRUE, 0, (size_t)Np*Np*sizeof(int), flatC, 0, NULL, NULL);
 
     // ----------------------------
-    // Verify correctness
+    // Verify correctness (Freivalds, O(N^2) per round)
     // ----------------------------
-    int errors = 0;
-    for (int k = 0; k < N*N; k++) {
-        if (flatC[k] != C[k/N][k%N]) {
-            errors++;
-            break;
-        }
-    }
+    gettimeofday(&t1, NULL);
+    int ok = freivaldsVerifyFlat(flatA, flatB, flatC, N, Np, FREIVALDS_ROUNDS);
+    gettimeofday(&t2, NULL);
+    double verify_time = (t2.tv_sec - t1.tv_sec) + (t2.tv_usec - t1.tv_usec)/1e6;
+    printf("Verification (%d Freivalds rounds): %s, %.4f sec\n", FREIVALDS_ROUNDS, ok == FREIVALDS_NOMEM ? "not run (out of memory)" : ok ? "passed" : "FAILED", verify_time);
 
     // Cleanup
     clReleaseMemObject(bufA);
@@ -1,106 +1,220 @@
 #include <stdio.h>
 #include <stdlib.h>
-#include <stdbool.h>
 #include <pthread.h>
+#include <stdatomic.h>
 #include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "../common/nqueens_bits.h"
+#include "../common/workstealing.h"
+
+// Build: gcc -O3 nqueens.c ../common/workstealing.c -o nqueens -lpthread
 
 #define N 15
-#define K 2 // depth of partial exploration before spawning threads
-#define MAX_THREADS 1000
-#define MAX_PARALLEL_THREADS 4
+#define K 0 // depth of the prefixes handed to threads; 0 picks it automatically
+#define MAX_PARALLEL_THREADS 4 // size of the worker pool
+#define TASKS_PER_THREAD 32 // automatic K: deepen until there are this many prefixes per thread
 #define RUN_SEQUENTIAL 1 // 0 for parallel
- 
-int total_solutions = 0;
-pthread_mutex_t total_mutex;
+#define USE_WORK_STEALING 0 // parallel: 1 forks subtrees on the work-stealing pool, 0 uses the prefix queue
+#define SPLIT_DEPTH 4 // work stealing: rows placed by forking tasks before a subtree is counted in one go
+#define USE_SYMMETRY 1   // search half the first row, double the count
+#define COUNT_UNIQUE 1   // also count solutions distinct under rotation/reflection
+
+long long total_solutions = 0;
 
 typedef struct {
-    int partial_board[N];
-    int col;
-} thread_arg_t;
-
-// Check if it's safe to place a queen at (row, col)
-bool isSafe(int board[], int row, int col) {
-    for (int i = 0; i < col; i++) {
-        if (board[i] == row || abs(board[i] - row) == col - i)
-            return false;
-    }
-    return true;
-}
+    const nqueens_prefixes_t* queue;
+    atomic_int* next;
+    int n;
+    long long count;   // this thread's total, summed after the join
+} worker_arg_t;
 
-// Recursive backtracking solver
+// Count the completions of board[0..col) with the bitboard kernel
 void solve(int board[], int col, int* count) {
-    if (col == N) {
-        (*count)++;
-        return;
-    }
-
-    for (int row = 0; row < N; row++) {
-        if (isSafe(board, row, col)) {
-            board[col] = row;
-            solve(board, col + 1, count);
-        }
-    }
+    unsigned int cols, ld, rd;
+    if (nqueensMasks(N, board, col, &cols, &ld, &rd))
+        *count += (int)nqueensCount(N, col, cols, ld, rd);
 }
 
-// Thread worker
+// Pool worker: claim the next prefix until the queue runs dry
 void* thread_worker(void* arg) {
-    thread_arg_t* data = (thread_arg_t*)arg;
-    int count = 0;
-    int board[N];
-    memcpy(board, data->partial_board, sizeof(board));
-
-    solve(board, data->col, &count);
-
-    // Safely update global solution count
-    pthread_mutex_lock(&total_mutex);
-    total_solutions += count;
-    pthread_mutex_unlock(&total_mutex);
+    worker_arg_t* w = (worker_arg_t*)arg;
+    const nqueens_prefixes_t* q = w->queue;
+    long long count = 0;
+
+    int i;
+    while ((i = atomic_fetch_add(w->next, 1)) < q->count) {
+        const nqueens_prefix_t* p = &q->items[i];
+        count += p->weight * nqueensCount(w->n, q->depth, p->cols, p->ld, p->rd);
+    }
 
-    free(arg);
+    w->count = count;
     return NULL;
 }
 
-void spawn_threads() {
-    pthread_t threads[MAX_THREADS];
-    int thread_count = 0;
+// Solve for n with a fixed pool of worker threads pulling depth-K prefixes
+// from a shared queue; returns the total and reports the depth used
+long long spawn_threads(int n, int num_threads, int* depth_used, int* tasks) {
+    // K if set, else deep enough for TASKS_PER_THREAD prefixes per thread
+    nqueens_prefixes_t queue = {NULL, 0, 0, 0};
+    nqueensChoosePrefixes(&queue, n, K, TASKS_PER_THREAD * num_threads, USE_SYMMETRY);
+
+    atomic_int next = 0;
+    pthread_t threads[num_threads];
+    worker_arg_t args[num_threads];
+    for (int t = 0; t < num_threads; t++) {
+        args[t] = (worker_arg_t){&queue, &next, n, 0};
+        pthread_create(&threads[t], NULL, thread_worker, &args[t]);
+    }
 
-    int board[N];
+    long long total = 0;
+    for (int t = 0; t < num_threads; t++) {
+        pthread_join(threads[t], NULL);
+        total += args[t].count;
+    }
 
-    // Loop through partial solutions (K = 2 for row1 and row2)
-    for (int row1 = 0; row1 < N; row1++) {
-        board[0] = row1;
-        for (int row2 = 0; row2 < N; row2++) {
-            board[1] = row2;
-            if (isSafe(board, row2, 1)) {
-                if (thread_count >= MAX_PARALLEL_THREADS) {
-                    // Stop spawning more threads
-                    break;
-                }
+    if (depth_used) *depth_used = queue.depth;
+    if (tasks) *tasks = queue.count;
+    free(queue.items);
+    return total;
+}
 
-                thread_arg_t* arg = malloc(sizeof(thread_arg_t));
-                memcpy(arg->partial_board, board, sizeof(board));
-                arg->col = 2; // because K = 2
+// Work-stealing version: every task places the next row's queen in each
+// free square and forks the resulting subtree, down to SPLIT_DEPTH rows;
+// below that a task counts its subtree with the bitboard kernel. Idle
+// workers steal the larger subtrees near the top of a busy worker's deque,
+// so uneven branches even out without building a prefix list first. Each
+// worker adds into its own slot (no atomics or mutex).
+long long worker_counts[MAX_PARALLEL_THREADS];
+int worker_tasks[MAX_PARALLEL_THREADS];
 
-                pthread_create(&threads[thread_count++], NULL, thread_worker, arg);
+typedef struct {
+    int n, row, split;
+    unsigned int cols, ld, rd;
+    int weight;   // 2 when the subtree also stands for its mirror image
+} queens_task_t;
+
+static void ws_queens(void* arg) {
+    queens_task_t* t = (queens_task_t*)arg;
+    if (t->row >= t->split) {
+        int w = ws_worker_id();
+        worker_counts[w] += t->weight * nqueensCount(t->n, t->row, t->cols, t->ld, t->rd);
+        worker_tasks[w]++;
+        return;
+    }
+
+    unsigned int all = nqueensAll(t->n);
+    unsigned int avail = all & ~(t->cols | t->ld | t->rd);
+    while (avail) {
+        unsigned int bit = avail & -avail;
+        avail ^= bit;
+        queens_task_t child = {t->n, t->row + 1, t->split, t->cols | bit,
+                               ((t->ld | bit) << 1) & all, (t->rd | bit) >> 1, t->weight};
+        ws_spawn(ws_queens, &child, sizeof(child));
+    }
+}
+
+// Root task: the first row, mirror-reduced the same way as the prefix
+// queue (left half at weight 2; for odd n the middle square with the
+// second row in its left half)
+static void ws_queens_root(void* arg) {
+    queens_task_t* root = (queens_task_t*)arg;
+    int n = root->n;
+    unsigned int all = nqueensAll(n);
+
+    for (int c = 0; c < n; c++) {
+        unsigned int bit = 1u << c;
+        queens_task_t child = {n, 1, root->split, bit, (bit << 1) & all, bit >> 1, 1};
+        if (!USE_SYMMETRY || n == 1) {
+            ws_spawn(ws_queens, &child, sizeof(child));
+        } else if (c < n / 2) {
+            child.weight = 2;
+            ws_spawn(ws_queens, &child, sizeof(child));
+        } else if (c == n / 2 && n % 2) {
+            unsigned int avail = (bit - 1) & ~(child.cols | child.ld | child.rd);
+            while (avail) {
+                unsigned int b1 = avail & -avail;
+                avail ^= b1;
+                queens_task_t second = {n, 2, root->split, bit | b1,
+                                        ((child.ld | b1) << 1) & all, (child.rd | b1) >> 1, 2};
+                ws_spawn(ws_queens, &second, sizeof(second));
             }
         }
+    }
+}
 
-        if (thread_count >= MAX_PARALLEL_THREADS)
-            break;
+// Same contract as spawn_threads; tasks is the number of subtrees counted
+long long spawn_tasks(int n, int num_threads, int* depth_used, int* tasks) {
+    for (int t = 0; t < num_threads; t++) {
+        worker_counts[t] = 0;
+        worker_tasks[t] = 0;
     }
 
-    for (int i = 0; i < thread_count; i++) {
-        pthread_join(threads[i], NULL);
+    int split = (SPLIT_DEPTH < n) ? SPLIT_DEPTH : n;
+    if (USE_SYMMETRY && n % 2 && n > 1 && split < 2)
+        split = 2;
+    ws_pool_t* pool = ws_create(num_threads);
+    queens_task_t root = {n, 0, split, 0, 0, 0, 1};
+    ws_run(pool, ws_queens_root, &root, sizeof(root));
+    ws_destroy(pool);
+
+    long long total = 0;
+    int leaves = 0;
+    for (int t = 0; t < num_threads; t++) {
+        total += worker_counts[t];
+        leaves += worker_tasks[t];
     }
+    if (depth_used) *depth_used = split;
+    if (tasks) *tasks = leaves;
+    return total;
 }
 
+long long solve_parallel(int n, int num_threads, int* depth_used, int* tasks) {
+    if (USE_WORK_STEALING)
+        return spawn_tasks(n, num_threads, depth_used, tasks);
+    return spawn_threads(n, num_threads, depth_used, tasks);
+}
 
-int main() {
-    clock_t start = clock();
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
 
-    pthread_mutex_init(&total_mutex, NULL);
+// ./nqueens scale [max_n]: wall time for N = 14..max_n (default 18) with
+// 1, 2, 4, ... MAX_PARALLEL_THREADS workers, and speedup over one worker.
+// Speedup only means something up to the number of cores, so rows with
+// more workers than online cores are flagged.
+void scaling_report(int max_n) {
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    printf("Online cores: %ld%s\n", cores,
+           (cores < MAX_PARALLEL_THREADS) ? " (rows marked * oversubscribe them; rerun on a larger host for real speedup)" : "");
+    printf("%3s %8s %7s %6s %14s %10s %8s\n", "N", "threads", "depth", "tasks", "solutions", "seconds", "speedup");
+    for (int n = 14; n <= max_n; n++) {
+        double base = 0;
+        for (int threads = 1; threads <= MAX_PARALLEL_THREADS; threads *= 2) {
+            int depth, tasks;
+            double start = now_seconds();
+            long long total = solve_parallel(n, threads, &depth, &tasks);
+            double elapsed = now_seconds() - start;
+            if (threads == 1) base = elapsed;
+            printf("%3d %8d %7d %6d %14lld %10.3f %8.2f%s\n", n, threads, depth, tasks, total, elapsed,
+                   base / elapsed, (threads > cores) ? " *" : "");
+        }
+    }
+}
+
+int main(int argc, char* argv[]) {
+    if (argc > 1 && strcmp(argv[1], "scale") == 0) {
+        scaling_report(argc > 2 ? atoi(argv[2]) : 18);
+        return 0;
+    }
 
-    if (RUN_SEQUENTIAL) {
+    double start = now_seconds();
+
+    if (RUN_SEQUENTIAL && USE_SYMMETRY) {
+        total_solutions = nqueensCountMirror(N);
+    } else if (RUN_SEQUENTIAL) {
         int board[N];
         for (int i = 0; i < N; i++) board[i] = -1;
 
@@ -109,20 +223,24 @@ int main() {
 
         total_solutions = count;
     } else {
-        spawn_threads();  // Run the parallel version
+        total_solutions = solve_parallel(N, MAX_PARALLEL_THREADS, NULL, NULL);  // Run the parallel version
     }
 
-    pthread_mutex_destroy(&total_mutex);
-
-    clock_t end = clock();
-    double duration = (double)(end - start) / CLOCKS_PER_SEC;
+    double duration = now_seconds() - start;
 
-    printf("Total solutions for N=%d: %d\n", N, total_solutions);
+    printf("Total solutions for N=%d: %lld\n", N, total_solutions);
     if (RUN_SEQUENTIAL)
         printf("Execution time (sequential): %.4f seconds\n", duration);
     else
         printf("Execution time (parallel with %d threads): %.4f seconds\n", MAX_PARALLEL_THREADS, duration);
 
+    if (COUNT_UNIQUE) {
+        double unique_start = now_seconds();
+        long long unique = nqueensCountUnique(N);
+        printf("Unique solutions (up to rotation/reflection): %lld (%.4f seconds)\n",
+               unique, now_seconds() - unique_start);
+    }
+
     return 0;
 }
 
@@ -0,0 +1,105 @@
+#ifndef FREIVALDS_H
+#define FREIVALDS_H
+
+// Freivalds' check that C == A * B in O(n^2) per round instead of the
+// O(n^3) of recomputing the product: pick a random vector r and compare
+// A * (B * r) with C * r. A wrong C survives one round with probability
+// at most 1/2, so FREIVALDS_ROUNDS rounds miss it with at most 2^-rounds.
+//
+// Arithmetic is unsigned 32-bit, i.e. modulo 2^32, which is exactly what
+// int overflow in the multiply kernels produces, so large products still
+// verify.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <time.h>
+
+#define FREIVALDS_ROUNDS 10
+#define FREIVALDS_NOMEM (-1)    // the check itself could not allocate
+
+static uint32_t freivaldsNext(uint64_t* state)
+{
+    // xorshift64*
+    *state ^= *state >> 12;
+    *state ^= *state << 25;
+    *state ^= *state >> 27;
+    return (uint32_t)((*state * 0x2545F4914F6CDD1DULL) >> 32);
+}
+
+// y = M * x over the row pointers of an n x n matrix; the rows are split
+// across threads only when the caller is built with OpenMP
+static void freivaldsMatVec(int** M, const uint32_t* x, uint32_t* y, int n)
+{
+#ifdef _OPENMP
+    #pragma omp parallel for schedule(static)
+#endif
+    for (int i = 0; i < n; i++) {
+        uint32_t sum = 0;
+        for (int j = 0; j < n; j++)
+            sum += (uint32_t)M[i][j] * x[j];
+        y[i] = sum;
+    }
+}
+
+// Returns 1 if C == A * B passed all rounds, 0 on the first failing round,
+// or FREIVALDS_NOMEM if the work vectors could not be allocated. Matrices are given as row pointers (the int** layout used by most of the
+// assignments).
+int freivaldsVerify(int** A, int** B, int** C, int n, int rounds)
+{
+    uint32_t* r   = (uint32_t*)malloc(n * sizeof(uint32_t));
+    uint32_t* Br  = (uint32_t*)malloc(n * sizeof(uint32_t));
+    uint32_t* ABr = (uint32_t*)malloc(n * sizeof(uint32_t));
+    uint32_t* Cr  = (uint32_t*)malloc(n * sizeof(uint32_t));
+    if (r == NULL || Br == NULL || ABr == NULL || Cr == NULL) {
+        free(r);
+        free(Br);
+        free(ABr);
+        free(Cr);
+        return FREIVALDS_NOMEM;
+    }
+    uint64_t state = (uint64_t)time(NULL) * 0x9E3779B97F4A7C15ULL | 1;
+    int ok = 1;
+
+    for (int round = 0; round < rounds && ok; round++) {
+        for (int j = 0; j < n; j++)
+            r[j] = freivaldsNext(&state);
+
+        freivaldsMatVec(B, r, Br, n);
+        freivaldsMatVec(A, Br, ABr, n);
+        freivaldsMatVec(C, r, Cr, n);
+
+        for (int i = 0; i < n; i++) {
+            if (ABr[i] != Cr[i]) {
+                ok = 0;
+                break;
+            }
+        }
+    }
+
+    free(r);
+    free(Br);
+    free(ABr);
+    free(Cr);
+    return ok;
+}
+
+// Same check for flat row-major matrices with leading dimension ld
+// (ld == n unless the matrices are padded)
+int freivaldsVerifyFlat(const int* A, const int* B, const int* C, int n, int ld, int rounds)
+{
+    int** rows = (int**)malloc(3 * n * sizeof(int*));
+    if (rows == NULL)
+        return FREIVALDS_NOMEM;
+    for (int i = 0; i < n; i++) {
+        rows[i]         = (int*)A + (size_t)i * ld;
+        rows[n + i]     = (int*)B + (size_t)i * ld;
+        rows[2 * n + i] = (int*)C + (size_t)i * ld;
+    }
+
+    int ok = freivaldsVerify(rows, rows + n, rows + 2 * n, n, rounds);
+    free(rows);
+    return ok;
+}
+
+#endif
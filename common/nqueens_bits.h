@@ -0,0 +1,313 @@
+#ifndef NQUEENS_BITS_H
+#define NQUEENS_BITS_H
+
+// Bitboard N-Queens kernel, for n <= 32.
+//
+// Instead of rescanning earlier queens for every candidate square, the
+// occupied columns and both diagonals are kept as bit masks relative to
+// the row being filled. Moving down a row shifts the diagonal masks by one,
+// the free squares are ~(cols | ld | rd), and x & -x peels them off one at
+// a time. The search is iterative with an explicit stack of at most n
+// frames, so there is no recursion and no per-node function call.
+//
+// "Row" here is whatever the caller places one queen per step in; the
+// solvers in this repo fill columns, so board[row] holds a column's queen.
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define NQUEENS_MAX 32
+
+typedef void (*nqueens_visit_fn)(int board[], int n);
+
+static inline unsigned int nqueensAll(int n)
+{
+    return (n >= 32) ? ~0u : (1u << n) - 1;
+}
+
+// Masks for the row after the prefix board[0..rows). Returns 0 if two
+// queens of the prefix attack each other.
+static inline int nqueensMasks(int n, const int board[], int rows,
+                               unsigned int* cols, unsigned int* ld, unsigned int* rd)
+{
+    unsigned int c = 0, l = 0, r = 0;
+    for (int i = 0; i < rows; i++) {
+        unsigned int bit = 1u << board[i];
+        if ((c | l | r) & bit)
+            return 0;
+        c |= bit;
+        l = (l | bit) << 1;
+        r = (r | bit) >> 1;
+    }
+    *cols = c;
+    *ld = l & nqueensAll(n);
+    *rd = r;
+    return 1;
+}
+
+// Number of ways to finish rows row..n-1 given the masks for row
+static inline long long nqueensCount(int n, int row, unsigned int cols, unsigned int ld, unsigned int rd)
+{
+    if (row >= n)
+        return 1;
+
+    const unsigned int all = nqueensAll(n);
+    unsigned int stackAvail[NQUEENS_MAX], stackCols[NQUEENS_MAX];
+    unsigned int stackLd[NQUEENS_MAX], stackRd[NQUEENS_MAX];
+    int last = n - row - 1;  // depth of the final row
+    int depth = 0;
+    long long count = 0;
+    unsigned int avail = all & ~(cols | ld | rd);
+
+    while (1) {
+        if (depth == last) {
+            // every free square on the last row is a solution
+            count += __builtin_popcount(avail);
+            avail = 0;
+        }
+        if (avail) {
+            unsigned int bit = avail & -avail;
+            avail ^= bit;
+            stackAvail[depth] = avail;
+            stackCols[depth] = cols;
+            stackLd[depth] = ld;
+            stackRd[depth] = rd;
+            depth++;
+            cols |= bit;
+            ld = (ld | bit) << 1;
+            rd = (rd | bit) >> 1;
+            avail = all & ~(cols | ld | rd);
+        } else {
+            if (depth == 0)
+                break;
+            depth--;
+            avail = stackAvail[depth];
+            cols = stackCols[depth];
+            ld = stackLd[depth];
+            rd = stackRd[depth];
+        }
+    }
+    return count;
+}
+
+// Eight-fold symmetry: board is the representative of its class if no
+// rotation or reflection of it is lexicographically smaller
+static inline int nqueensIsCanonical(const int board[], int n)
+{
+    int t[NQUEENS_MAX];
+    for (int k = 1; k < 8; k++) {
+        for (int r = 0; r < n; r++) {
+            int c = (k & 4) ? n - 1 - board[r] : board[r];  // reflect first
+            switch (k & 3) {
+            case 0: t[r] = c; break;                        // reflection only
+            case 1: t[c] = n - 1 - r; break;                // rotate 90
+            case 2: t[n - 1 - r] = n - 1 - c; break;        // rotate 180
+            case 3: t[n - 1 - c] = r; break;                // rotate 270
+            }
+        }
+        for (int r = 0; r < n && t[r] <= board[r]; r++)
+            if (t[r] < board[r])
+                return 0;
+    }
+    return 1;
+}
+
+// Fills board[row..n) with every completion of the prefix the masks
+// describe, calling visit (may be NULL) on each; counts them all, or only
+// the canonical ones if canonicalOnly is set
+static inline long long nqueensWalk(int n, int board[], int row, unsigned int cols, unsigned int ld,
+                                    unsigned int rd, nqueens_visit_fn visit, int canonicalOnly)
+{
+    if (row >= n) {
+        if (canonicalOnly && !nqueensIsCanonical(board, n))
+            return 0;
+        if (visit)
+            visit(board, n);
+        return 1;
+    }
+
+    const unsigned int all = nqueensAll(n);
+    unsigned int stackAvail[NQUEENS_MAX], stackCols[NQUEENS_MAX];
+    unsigned int stackLd[NQUEENS_MAX], stackRd[NQUEENS_MAX];
+    int depth = row;
+    long long count = 0;
+    unsigned int avail = all & ~(cols | ld | rd);
+
+    while (1) {
+        if (avail) {
+            unsigned int bit = avail & -avail;
+            avail ^= bit;
+            board[depth] = __builtin_ctz(bit);
+            if (depth == n - 1) {
+                if (!canonicalOnly || nqueensIsCanonical(board, n)) {
+                    count++;
+                    if (visit)
+                        visit(board, n);
+                }
+                continue;
+            }
+            stackAvail[depth] = avail;
+            stackCols[depth] = cols;
+            stackLd[depth] = ld;
+            stackRd[depth] = rd;
+            depth++;
+            cols |= bit;
+            ld = (ld | bit) << 1;
+            rd = (rd | bit) >> 1;
+            avail = all & ~(cols | ld | rd);
+        } else {
+            if (depth == row)
+                break;
+            depth--;
+            avail = stackAvail[depth];
+            cols = stackCols[depth];
+            ld = stackLd[depth];
+            rd = stackRd[depth];
+        }
+    }
+    return count;
+}
+
+// Like nqueensCount, but fills board[row..n) and calls visit for every
+// solution; board[0..row) must already hold the prefix the masks describe
+static inline long long nqueensEnumerate(int n, int board[], int row, unsigned int cols,
+                                         unsigned int ld, unsigned int rd, nqueens_visit_fn visit)
+{
+    return nqueensWalk(n, board, row, cols, ld, rd, visit, 0);
+}
+
+// All solutions, searching only half the tree: mirroring the board swaps
+// first-row squares c and n-1-c, so the left half is counted twice. With
+// odd n the middle square is its own mirror; under it the second row
+// (which can't use the middle) is split the same way.
+static inline long long nqueensCountMirror(int n)
+{
+    if (n == 1)
+        return 1;
+
+    long long half = 0;
+    for (int c = 0; c < n / 2; c++) {
+        unsigned int bit = 1u << c;
+        half += nqueensCount(n, 1, bit, (bit << 1) & nqueensAll(n), bit >> 1);
+    }
+    if (n % 2) {
+        int board[2] = {n / 2, 0};
+        unsigned int cols, ld, rd;
+        for (int c = 0; c < n / 2; c++) {
+            board[1] = c;
+            if (nqueensMasks(n, board, 2, &cols, &ld, &rd))
+                half += nqueensCount(n, 2, cols, ld, rd);
+        }
+    }
+    return 2 * half;
+}
+
+// Solutions that are distinct under rotation and reflection. The smallest
+// board of every class has its first queen in the left half (or in the
+// middle with the second queen in the left half), so the same half of the
+// tree is searched and each solution found is kept if it is canonical.
+static inline long long nqueensCountUnique(int n)
+{
+    int board[NQUEENS_MAX];
+    unsigned int cols, ld, rd;
+    long long unique = 0;
+
+    for (int c = 0; c < (n + 1) / 2; c++) {
+        board[0] = c;
+        if (c == n / 2 && n % 2 && n > 1) {
+            for (int c1 = 0; c1 < n / 2; c1++) {
+                board[1] = c1;
+                if (nqueensMasks(n, board, 2, &cols, &ld, &rd))
+                    unique += nqueensWalk(n, board, 2, cols, ld, rd, NULL, 1);
+            }
+        } else {
+            nqueensMasks(n, board, 1, &cols, &ld, &rd);
+            unique += nqueensWalk(n, board, 1, cols, ld, rd, NULL, 1);
+        }
+    }
+    return unique;
+}
+
+// ---- Prefixes for parallel and distributed solvers ----
+
+// A subtree to search: masks after the first depth rows, and how many
+// times its solutions count (2 when it stands for its mirror image too)
+typedef struct {
+    unsigned int cols, ld, rd;
+    int weight;
+} nqueens_prefix_t;
+
+typedef struct {
+    nqueens_prefix_t* items;
+    int count;
+    int capacity;
+    int depth;
+} nqueens_prefixes_t;
+
+static inline void nqueensPushPrefix(nqueens_prefixes_t* q, unsigned int cols, unsigned int ld,
+                                     unsigned int rd, int weight)
+{
+    if (q->count == q->capacity) {
+        q->capacity = q->capacity ? 2 * q->capacity : 1024;
+        q->items = (nqueens_prefix_t*)realloc(q->items, q->capacity * sizeof(nqueens_prefix_t));
+    }
+    q->items[q->count++] = (nqueens_prefix_t){cols, ld, rd, weight};
+}
+
+// Every valid placement of rows row..depth-1 below the given masks
+static inline void nqueensGenPrefixes(nqueens_prefixes_t* q, int n, int row, unsigned int cols,
+                                      unsigned int ld, unsigned int rd, int weight)
+{
+    if (row == q->depth) {
+        nqueensPushPrefix(q, cols, ld, rd, weight);
+        return;
+    }
+    unsigned int avail = nqueensAll(n) & ~(cols | ld | rd);
+    while (avail) {
+        unsigned int bit = avail & -avail;
+        avail ^= bit;
+        nqueensGenPrefixes(q, n, row + 1, cols | bit, ((ld | bit) << 1) & nqueensAll(n), (rd | bit) >> 1, weight);
+    }
+}
+
+// All prefixes of the given depth, replacing q's contents. With symmetry
+// only the left half of the first row is used, at weight 2; for odd n the
+// middle square is expanded with the second row restricted to its left
+// half (also weight 2), so depth is raised to at least 2.
+static inline void nqueensBuildPrefixes(nqueens_prefixes_t* q, int n, int depth, int symmetry)
+{
+    if (symmetry && n % 2 && n > 1 && depth < 2)
+        depth = 2;
+    if (depth > n)
+        depth = n;
+    q->count = 0;
+    q->depth = depth;
+    for (int c = 0; c < n; c++) {
+        unsigned int bit = 1u << c;
+        unsigned int ld = (bit << 1) & nqueensAll(n), rd = bit >> 1;
+        if (!symmetry || n == 1) {
+            nqueensGenPrefixes(q, n, 1, bit, ld, rd, 1);
+        } else if (c < n / 2) {
+            nqueensGenPrefixes(q, n, 1, bit, ld, rd, 2);
+        } else if (c == n / 2 && n % 2) {
+            unsigned int avail = (bit - 1) & ~(bit | ld | rd);  // second row, left of the middle
+            while (avail) {
+                unsigned int b1 = avail & -avail;
+                avail ^= b1;
+                nqueensGenPrefixes(q, n, 2, bit | b1, ((ld | b1) << 1) & nqueensAll(n), (rd | b1) >> 1, 2);
+            }
+        }
+    }
+}
+
+// depth if it is > 0, else the shallowest depth from 2 that yields at
+// least minTasks prefixes, so that uneven subtrees even out
+static inline void nqueensChoosePrefixes(nqueens_prefixes_t* q, int n, int depth, int minTasks, int symmetry)
+{
+    int d = (depth > 0) ? depth : 2;
+    nqueensBuildPrefixes(q, n, d, symmetry);
+    while (depth <= 0 && q->count < minTasks && q->depth < n - 1)
+        nqueensBuildPrefixes(q, n, q->depth + 1, symmetry);
+}
+
+#endif
@@ -0,0 +1,374 @@
+#include "workstealing.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <sched.h>
+
+#define WS_SLAB 256   // task descriptors allocated at a time
+
+typedef struct ws_task {
+    ws_fn_t fn;
+    struct ws_task* parent;
+    struct ws_task* next_free;
+    struct ws_worker* owner;      // whose slab this descriptor lives in
+    atomic_int children;          // spawned and not yet finished
+    union {
+        max_align_t align;
+        unsigned char bytes[WS_ARG_SIZE];
+    } arg;
+} ws_task_t;
+
+typedef struct ws_slab {
+    struct ws_slab* next;
+    ws_task_t tasks[WS_SLAB];
+} ws_slab_t;
+
+// Chase-Lev deque with a fixed ring (Le et al., "Correct and Efficient
+// Work-Stealing for Weak Memory Models", 2013). The owner works at bottom,
+// thieves take from top; only the last element is contended.
+typedef struct {
+    _Alignas(64) atomic_long top;
+    _Alignas(64) atomic_long bottom;
+    _Atomic(ws_task_t*) buf[WS_DEQUE_SIZE];
+} ws_deque_t;
+
+typedef struct ws_worker {
+    ws_deque_t deque;
+    ws_pool_t* pool;
+    int id;
+    ws_task_t* current;           // task whose children ws_spawn() adds to
+    ws_task_t* free_list;
+    ws_slab_t* slabs;
+    _Alignas(64) _Atomic(ws_task_t*) returned;  // freed by other workers
+    unsigned int rng;
+    long steals;
+    pthread_t thread;
+} ws_worker_t;
+
+struct ws_pool {
+    int num_workers;
+    ws_worker_t* workers;
+    atomic_int active;            // a ws_run() is in progress
+    atomic_int shutdown;
+    pthread_mutex_t idle_mutex;
+    pthread_cond_t idle_cond;
+};
+
+static __thread ws_worker_t* ws_self = NULL;
+
+// ------------- Deque --------------------------------------------
+
+static int deque_push(ws_deque_t* d, ws_task_t* t)
+{
+    long b = atomic_load_explicit(&d->bottom, memory_order_relaxed);
+    long top = atomic_load_explicit(&d->top, memory_order_acquire);
+    if (b - top >= WS_DEQUE_SIZE)
+        return 0;
+    atomic_store_explicit(&d->buf[b & (WS_DEQUE_SIZE - 1)], t, memory_order_relaxed);
+    // Release publishes the task's contents to the thief that acquires bottom
+    atomic_store_explicit(&d->bottom, b + 1, memory_order_release);
+    return 1;
+}
+
+static ws_task_t* deque_pop(ws_deque_t* d)
+{
+    long b = atomic_load_explicit(&d->bottom, memory_order_relaxed) - 1;
+    atomic_store_explicit(&d->bottom, b, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    long top = atomic_load_explicit(&d->top, memory_order_relaxed);
+
+    if (top > b) {  // empty
+        atomic_store_explicit(&d->bottom, b + 1, memory_order_relaxed);
+        return NULL;
+    }
+
+    ws_task_t* t = atomic_load_explicit(&d->buf[b & (WS_DEQUE_SIZE - 1)], memory_order_relaxed);
+    if (top == b) {  // last element: race the thieves for it
+        if (!atomic_compare_exchange_strong_explicit(&d->top, &top, top + 1,
+                                                     memory_order_seq_cst, memory_order_relaxed))
+            t = NULL;
+        atomic_store_explicit(&d->bottom, b + 1, memory_order_relaxed);
+    }
+    return t;
+}
+
+static ws_task_t* deque_steal(ws_deque_t* d)
+{
+    long top = atomic_load_explicit(&d->top, memory_order_acquire);
+    atomic_thread_fence(memory_order_seq_cst);
+    long b = atomic_load_explicit(&d->bottom, memory_order_acquire);
+    if (top >= b)
+        return NULL;
+
+    ws_task_t* t = atomic_load_explicit(&d->buf[top & (WS_DEQUE_SIZE - 1)], memory_order_relaxed);
+    if (!atomic_compare_exchange_strong_explicit(&d->top, &top, top + 1,
+                                                 memory_order_seq_cst, memory_order_relaxed))
+        return NULL;  // lost to the owner or another thief
+    return t;
+}
+
+// ------------- Task descriptors ---------------------------------
+
+static ws_task_t* task_alloc(ws_worker_t* w)
+{
+    // Take back everything thieves have returned before growing. Other
+    // workers only ever push and we take the whole stack at once, so
+    // there is no ABA problem.
+    if (!w->free_list)
+        w->free_list = atomic_exchange_explicit(&w->returned, NULL, memory_order_acquire);
+
+    if (!w->free_list) {
+        ws_slab_t* slab = (ws_slab_t*)malloc(sizeof(ws_slab_t));
+        if (!slab) {
+            fprintf(stderr, "ws: out of memory\n");
+            exit(-1);
+        }
+        slab->next = w->slabs;
+        w->slabs = slab;
+        for (int i = 0; i < WS_SLAB; i++) {
+            slab->tasks[i].owner = w;
+            slab->tasks[i].next_free = w->free_list;
+            w->free_list = &slab->tasks[i];
+        }
+    }
+    ws_task_t* t = w->free_list;
+    w->free_list = t->next_free;
+    return t;
+}
+
+// Descriptors go back to the worker that allocated them: straight onto its
+// free list if that is us, otherwise onto its lock-free return stack.
+// Keeping them where they ran would leave a worker that mostly spawns
+// (while others steal and run its tasks) allocating slab after slab.
+static void task_free(ws_worker_t* w, ws_task_t* t)
+{
+    ws_worker_t* owner = t->owner;
+    if (owner == w) {
+        t->next_free = w->free_list;
+        w->free_list = t;
+        return;
+    }
+
+    ws_task_t* head = atomic_load_explicit(&owner->returned, memory_order_relaxed);
+    do {
+        t->next_free = head;
+    } while (!atomic_compare_exchange_weak_explicit(&owner->returned, &head, t,
+                                                    memory_order_release, memory_order_relaxed));
+}
+
+// ------------- Scheduling ---------------------------------------
+
+static ws_task_t* find_task(ws_worker_t* w)
+{
+    ws_task_t* t = deque_pop(&w->deque);
+    if (t)
+        return t;
+
+    int n = w->pool->num_workers;
+    for (int attempt = 0; attempt < n; attempt++) {
+        w->rng = w->rng * 1103515245u + 12345u;
+        int victim = (int)((w->rng >> 16) % (unsigned int)n);
+        if (victim == w->id)
+            continue;
+        t = deque_steal(&w->pool->workers[victim].deque);
+        if (t) {
+            w->steals++;
+            return t;
+        }
+    }
+    return NULL;
+}
+
+static void execute(ws_worker_t* w, ws_task_t* t)
+{
+    ws_task_t* prev = w->current;
+    w->current = t;
+    t->fn(t->arg.bytes);
+    ws_sync();
+    w->current = prev;
+
+    if (t->parent)
+        atomic_fetch_sub_explicit(&t->parent->children, 1, memory_order_release);
+    task_free(w, t);
+}
+
+void ws_sync(void)
+{
+    ws_worker_t* w = ws_self;
+    if (!w || !w->current)
+        return;
+
+    // Help out until the children are done; any task is fair game since
+    // nothing we run can depend on the one we are waiting in
+    ws_task_t* t = w->current;
+    while (atomic_load_explicit(&t->children, memory_order_acquire) > 0) {
+        ws_task_t* other = find_task(w);
+        if (other)
+            execute(w, other);
+        else
+            sched_yield();
+    }
+}
+
+void ws_spawn(ws_fn_t fn, const void* arg, size_t size)
+{
+    if (size > WS_ARG_SIZE) {
+        fprintf(stderr, "ws_spawn: argument of %zu bytes exceeds WS_ARG_SIZE\n", size);
+        exit(-1);
+    }
+
+    ws_worker_t* w = ws_self;
+    if (!w || !w->current) {
+        fn((void*)arg);
+        return;
+    }
+
+    ws_task_t* t = task_alloc(w);
+    t->fn = fn;
+    t->parent = w->current;
+    atomic_store_explicit(&t->children, 0, memory_order_relaxed);
+    memcpy(t->arg.bytes, arg, size);
+
+    atomic_fetch_add_explicit(&w->current->children, 1, memory_order_relaxed);
+    if (!deque_push(&w->deque, t)) {
+        // Deque full: the spawn tree is already far wider than the pool
+        atomic_fetch_sub_explicit(&w->current->children, 1, memory_order_relaxed);
+        task_free(w, t);
+        fn((void*)arg);
+    }
+}
+
+static void* worker_loop(void* arg)
+{
+    ws_worker_t* w = (ws_worker_t*)arg;
+    ws_pool_t* pool = w->pool;
+    ws_self = w;
+
+    while (!atomic_load(&pool->shutdown)) {
+        ws_task_t* t = find_task(w);
+        if (t) {
+            execute(w, t);
+            continue;
+        }
+
+        if (atomic_load(&pool->active)) {
+            sched_yield();
+        } else {
+            // Nothing running: sleep instead of spinning between runs
+            pthread_mutex_lock(&pool->idle_mutex);
+            while (!atomic_load(&pool->active) && !atomic_load(&pool->shutdown))
+                pthread_cond_wait(&pool->idle_cond, &pool->idle_mutex);
+            pthread_mutex_unlock(&pool->idle_mutex);
+        }
+    }
+    return NULL;
+}
+
+// ------------- Pool ---------------------------------------------
+
+ws_pool_t* ws_create(int num_workers)
+{
+    if (num_workers < 1)
+        num_workers = 1;
+
+    ws_pool_t* pool = (ws_pool_t*)malloc(sizeof(ws_pool_t));
+    pool->num_workers = num_workers;
+    pool->workers = (ws_worker_t*)aligned_alloc(64, num_workers * sizeof(ws_worker_t));
+    atomic_init(&pool->active, 0);
+    atomic_init(&pool->shutdown, 0);
+    pthread_mutex_init(&pool->idle_mutex, NULL);
+    pthread_cond_init(&pool->idle_cond, NULL);
+
+    for (int i = 0; i < num_workers; i++) {
+        ws_worker_t* w = &pool->workers[i];
+        memset(w, 0, sizeof(*w));
+        atomic_init(&w->deque.top, 0);
+        atomic_init(&w->deque.bottom, 0);
+        w->pool = pool;
+        w->id = i;
+        w->rng = 2654435761u * (unsigned int)(i + 1);
+        atomic_init(&w->returned, NULL);
+    }
+
+    for (int i = 1; i < num_workers; i++) {
+        int rc = pthread_create(&pool->workers[i].thread, NULL, worker_loop, &pool->workers[i]);
+        if (rc) {
+            fprintf(stderr, "Error creating worker %d\n", i);
+            exit(-1);
+        }
+    }
+    return pool;
+}
+
+void ws_destroy(ws_pool_t* pool)
+{
+    pthread_mutex_lock(&pool->idle_mutex);
+    atomic_store(&pool->shutdown, 1);
+    pthread_cond_broadcast(&pool->idle_cond);
+    pthread_mutex_unlock(&pool->idle_mutex);
+
+    for (int i = 1; i < pool->num_workers; i++)
+        pthread_join(pool->workers[i].thread, NULL);
+
+    for (int i = 0; i < pool->num_workers; i++) {
+        ws_slab_t* slab = pool->workers[i].slabs;
+        while (slab) {
+            ws_slab_t* next = slab->next;
+            free(slab);
+            slab = next;
+        }
+    }
+
+    pthread_mutex_destroy(&pool->idle_mutex);
+    pthread_cond_destroy(&pool->idle_cond);
+    free(pool->workers);
+    free(pool);
+}
+
+void ws_run(ws_pool_t* pool, ws_fn_t fn, const void* arg, size_t size)
+{
+    if (size > WS_ARG_SIZE) {
+        fprintf(stderr, "ws_run: argument of %zu bytes exceeds WS_ARG_SIZE\n", size);
+        exit(-1);
+    }
+
+    ws_worker_t* w = &pool->workers[0];
+    ws_worker_t* saved = ws_self;
+    ws_self = w;
+
+    pthread_mutex_lock(&pool->idle_mutex);
+    atomic_store(&pool->active, 1);
+    pthread_cond_broadcast(&pool->idle_cond);
+    pthread_mutex_unlock(&pool->idle_mutex);
+
+    ws_task_t* root = task_alloc(w);
+    root->fn = fn;
+    root->parent = NULL;
+    atomic_store_explicit(&root->children, 0, memory_order_relaxed);
+    memcpy(root->arg.bytes, arg, size);
+    execute(w, root);
+
+    atomic_store(&pool->active, 0);
+    ws_self = saved;
+}
+
+int ws_worker_id(void)
+{
+    return ws_self ? ws_self->id : -1;
+}
+
+int ws_num_workers(const ws_pool_t* pool)
+{
+    return pool->num_workers;
+}
+
+long ws_steals(const ws_pool_t* pool)
+{
+    long total = 0;
+    for (int i = 0; i < pool->num_workers; i++)
+        total += pool->workers[i].steals;
+    return total;
+}
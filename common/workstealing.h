@@ -0,0 +1,49 @@
+#ifndef WORKSTEALING_H
+#define WORKSTEALING_H
+
+// Work-stealing fork/join runtime on pthreads.
+//
+// Every worker owns a Chase-Lev deque: it pushes and pops spawned tasks at
+// the bottom without locks, and idle workers steal from the top of a random
+// victim. Inside a task, ws_spawn() forks a child and ws_sync() waits for
+// all children spawned so far by that task; a waiting worker keeps running
+// other tasks instead of blocking. Every task implicitly syncs before it
+// finishes, so a parent's locals stay valid for its children until it
+// returns. Task descriptors come from per-worker free lists and go back to
+// the worker that allocated them, wherever they ran, so steady-state
+// spawning does no malloc.
+//
+// Build: gcc ... ../common/workstealing.c -lpthread
+
+#include <stddef.h>
+
+#define WS_ARG_SIZE 64       // max bytes of argument copied into a task
+#define WS_DEQUE_SIZE 4096   // per-worker deque capacity (power of two)
+
+typedef void (*ws_fn_t)(void* arg);
+typedef struct ws_pool ws_pool_t;
+
+// Starts num_workers - 1 threads; the thread calling ws_run() is worker 0
+ws_pool_t* ws_create(int num_workers);
+void ws_destroy(ws_pool_t* pool);
+
+// Runs fn on a copy of arg[0..size) as the root task and returns once it
+// and everything it spawned have finished. One ws_run() at a time per pool.
+void ws_run(ws_pool_t* pool, ws_fn_t fn, const void* arg, size_t size);
+
+// Forks fn on a copy of arg[0..size), size <= WS_ARG_SIZE. Outside a pool
+// (or when the deque is full) fn simply runs inline.
+void ws_spawn(ws_fn_t fn, const void* arg, size_t size);
+
+// Waits for every task spawned by the current task
+void ws_sync(void);
+
+// Index of the calling worker in 0..num_workers-1, or -1 outside a pool;
+// handy for per-worker counters that need no locking
+int ws_worker_id(void);
+int ws_num_workers(const ws_pool_t* pool);
+
+// Successful steals since ws_create(), for reporting load balance
+long ws_steals(const ws_pool_t* pool);
+
+#endif